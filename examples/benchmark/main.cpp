@@ -0,0 +1,249 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Benchmark program that measures the simulation speed of a mid-sized
+	design with different simulator settings.
+
+	Usage: benchmark [channels] [taps] [cycles] [threads] [report]
+
+	A thread count of zero selects the simulator default.
+
+	'benchmark 80000 8 20 1' simulates a design of about one million blocks
+	on a single thread. Run it under 'perf stat -e cache-misses' to see the
+	effect of changes to the memory layout of the simulator.
+
+	The lane measurements simulate several copies of the design at once and
+	report the clock cycles of all lanes together. The packed measurement
+	stores the bool values of 64 lanes in one word.
+
+	The native measurement builds the design with the host C++ compiler
+	(see NativeCompiler) before the simulation is timed.
+
+	If 'report' is given, the simulator report is printed after every
+	measurement. The mixed measurements sum all channels into a single
+	output, which turns the design into one large component. In the idle
+	measurements only the first channel is running, which compares the
+	evaluation of whole components with event-driven evaluation.
+
+*/
+
+#include "../../lib/oddf/src/dfx.h"
+#include "../../lib/native/native.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <numeric>
+
+namespace b = dfx::blocks;
+
+struct Settings {
+
+	int channels;
+	int taps;
+	unsigned cycles;
+	int threads;
+	bool report;
+	bool mixed;
+	bool idle;
+	bool native;
+	int lanes;
+};
+
+struct Outputs {
+
+	std::vector<double const *> probes;
+
+	// Probes observe a single lane. With several lanes, the outputs are
+	// recorded by a sink in the last clock cycle instead.
+	std::unique_ptr<dfx::modules::BusSink<double>> sink;
+	std::unique_ptr<bool[]> capture;
+};
+
+// Builds a number of independent channels. Each channel consists of a phase
+// accumulator driving a FIR filter and a small polynomial. The outputs are
+// the channel outputs, or the sum of all channels if 'mixed' is set. If
+// 'idle' is set, the phases of all channels but the first stand still.
+static Outputs BuildDesign(Settings const &settings)
+{
+	Outputs result;
+	dfx::bus<double> outputs;
+
+	for (int channel = 0; channel < settings.channels; ++channel) {
+
+		double increment = settings.idle && channel > 0 ? 0.0 : 0.001 * (channel + 1);
+
+		dfx::forward_node<double> phase;
+		phase <<= b::Delay(b::Decide(phase > 1.0, phase - 2.0, phase + increment));
+
+		dfx::forward_bus<double> line(settings.taps, 0.0);
+		line <<= dfx::join(phase, b::Delay(line.most()));
+
+		std::vector<double> coefficients(settings.taps);
+		for (int i = 0; i < settings.taps; ++i)
+			coefficients[i] = 1.0 / (i + 1);
+
+		dfx::node<double> filtered = b::Sum(line * b::Constant(coefficients.begin(), coefficients.end()));
+		dfx::node<double> polynomial = filtered * (filtered * (filtered * 0.25 - 0.5) + 1.0);
+
+		outputs.append(polynomial);
+	}
+
+	if (settings.mixed)
+		outputs = dfx::bus<double>(b::Sum(outputs));
+
+	if (settings.lanes > 1) {
+
+		result.capture.reset(new bool[settings.lanes]());
+		result.sink = std::make_unique<dfx::modules::BusSink<double>>(outputs.width());
+		result.sink->Inputs.WriteEnable <<= b::Signal(result.capture.get());
+		result.sink->Inputs.Data <<= outputs;
+	}
+	else {
+
+		for (int i = 1; i <= outputs.width(); ++i)
+			result.probes.push_back(b::Probe(outputs(i)));
+	}
+
+	return result;
+}
+
+// Builds a fresh design, simulates it with the given simulator options and
+// reports the achieved clock cycles per second.
+static void Measure(std::string const &name, Settings const &settings, dfx::Simulator::Options const &options)
+{
+	dfx::Design design;
+	auto outputs = BuildDesign(settings);
+
+	dfx::Simulator simulator(design, options);
+
+	if (settings.native) {
+
+		std::ostringstream log;
+		NativeCompiler().Compile(simulator, settings.report ? std::cout : log);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	simulator.Run(settings.cycles);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// The sink records the values the probes would show in the next clock
+	// edge.
+	if (outputs.sink) {
+
+		std::fill(outputs.capture.get(), outputs.capture.get() + settings.lanes, true);
+		simulator.Run(1);
+	}
+
+	double checksum = 0;
+
+	for (auto const *probe : outputs.probes)
+		checksum += *probe;
+
+	// All lanes see the same stimulus and must agree with each other.
+	for (int lane = 0; outputs.sink && lane < settings.lanes; ++lane) {
+
+		auto const &data = outputs.sink->GetData(lane);
+		double laneChecksum = std::accumulate(data.begin(), data.end(), 0.0);
+
+		if (lane == 0)
+			checksum = laneChecksum;
+		else if (laneChecksum != checksum)
+			checksum = std::nan("");
+	}
+
+	// Cycles of all lanes together
+	std::uint64_t cycles = (std::uint64_t)settings.cycles * settings.lanes;
+
+	std::cout << std::setw(24) << std::left << name << std::right
+		<< std::setw(14) << (std::uint64_t)(cycles / seconds) << " cycles/s"
+		<< "    checksum " << std::setprecision(17) << checksum << std::endl;
+
+	if (settings.report) {
+
+		std::cout << std::endl;
+		simulator.Report(std::cout);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	Settings settings;
+
+	settings.channels = argc > 1 ? std::atoi(argv[1]) : 64;
+	settings.taps = argc > 2 ? std::atoi(argv[2]) : 32;
+	settings.cycles = argc > 3 ? (unsigned)std::atoi(argv[3]) : 20000;
+	settings.threads = argc > 4 ? std::atoi(argv[4]) : 0;
+	settings.report = argc > 5 && std::string(argv[5]) == "report";
+	settings.mixed = false;
+	settings.idle = false;
+	settings.native = false;
+	settings.lanes = 1;
+
+	std::cout << "Channels: " << settings.channels << ", taps: " << settings.taps << ", cycles: " << settings.cycles << std::endl << std::endl;
+
+	dfx::Simulator::Options options;
+	options.numberOfThreads = settings.threads;
+
+	options.mode = dfx::Simulator::Mode::Serial;
+	options.engine = dfx::Simulator::Engine::Blocks;
+	Measure("serial, blocks", settings, options);
+
+	options.engine = dfx::Simulator::Engine::Bytecode;
+	Measure("serial, bytecode", settings, options);
+
+	settings.native = true;
+	Measure("serial, native", settings, options);
+	settings.native = false;
+
+	options.lanes = settings.lanes = 8;
+	Measure("serial, 8 lanes", settings, options);
+
+	options.lanes = settings.lanes = 64;
+	options.packedBooleans = true;
+	Measure("serial, 64 lanes packed", settings, options);
+	options.lanes = settings.lanes = 1;
+	options.packedBooleans = false;
+
+	options.mode = dfx::Simulator::Mode::Parallel;
+	options.synchronisation = dfx::Simulator::Synchronisation::ConditionVariable;
+	Measure("condition variable", settings, options);
+
+	options.synchronisation = dfx::Simulator::Synchronisation::SpinThenPark;
+	Measure("spin-then-park", settings, options);
+
+	options.dirtyTracking = false;
+	Measure("no dirty tracking", settings, options);
+
+	options.dirtyTracking = true;
+	settings.mixed = true;
+	Measure("spin-then-park, mixed", settings, options);
+
+	options.mode = dfx::Simulator::Mode::Serial;
+	options.engine = dfx::Simulator::Engine::Blocks;
+	settings.idle = true;
+	Measure("idle, components", settings, options);
+
+	options.eventDriven = true;
+	Measure("idle, event-driven", settings, options);
+
+	return 0;
+}
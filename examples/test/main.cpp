@@ -43,7 +43,7 @@ dfx::node<nodeT> FirFilter(dfx::node<nodeT> const &input, std::vector<nodeT> con
 {
 	std::size_t length = coefficients.size();
 
-	dfx::forward_bus<nodeT> taps((int)length, input.GetDriver()->value);
+	dfx::forward_bus<nodeT> taps((int)length, input.GetDriver()->GetValue());
 
 	taps <<= dfx::join(input, b::Delay(taps.most()));
 
@@ -0,0 +1,50 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Native code emission for the decide block.
+
+*/
+
+#include "../global.h"
+#include "entities.h"
+
+namespace native_entities {
+
+	bool Decide::IsSupported(dfx::generator::Entity const &entity) const
+	{
+		int numberOfOutputs = (int)entity.outputs.size();
+		return numberOfOutputs > 0 && (int)entity.inputs.size() == 2 * numberOfOutputs + 1 && HasNativeTypes(*compiler, entity);
+	}
+
+	void Decide::WriteCode(std::ostream &f, dfx::generator::Entity const &entity) const
+	{
+		int numberOfOutputs = (int)entity.outputs.size();
+		std::string decision = compiler->GetInputExpression(entity, 0);
+
+		for (int i = 0; i < numberOfOutputs; ++i) {
+
+			compiler->WriteOutputDeclaration(f, entity, i);
+			f << "(" << decision << ") ? " << compiler->GetInputExpression(entity, 1 + 2 * i) << " : " << compiler->GetInputExpression(entity, 2 + 2 * i) << ";\n";
+			compiler->WriteOutputStore(f, entity, i);
+		}
+	}
+}
@@ -0,0 +1,109 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Classes for native code emission.
+
+*/
+
+#include "../native.h"
+
+namespace native_entities {
+
+// plus, times, and, or, xor
+
+class FlatOperator : public NativeEntityProcessor {
+
+private:
+
+	std::string op;
+	std::string defaultValue;
+
+public:
+
+	FlatOperator(NativeCompiler *theCompiler, std::string const &theOp, std::string const &theDefaultValue) :
+		NativeEntityProcessor(theCompiler), op(theOp), defaultValue(theDefaultValue) {}
+
+	bool IsSupported(dfx::generator::Entity const &entity) const override;
+	void WriteCode(std::ostream &f, dfx::generator::Entity const &entity) const override;
+};
+
+
+// equal, not_equal, less, less_equal
+
+class Compare : public NativeEntityProcessor {
+
+private:
+
+	std::string op;
+
+public:
+
+	Compare(NativeCompiler *theCompiler, std::string const &theOp) : NativeEntityProcessor(theCompiler), op(theOp) {}
+
+	bool IsSupported(dfx::generator::Entity const &entity) const override;
+	void WriteCode(std::ostream &f, dfx::generator::Entity const &entity) const override;
+};
+
+
+// negate, not
+
+class UnaryOperator : public NativeEntityProcessor {
+
+private:
+
+	std::string op;
+
+public:
+
+	UnaryOperator(NativeCompiler *theCompiler, std::string const &theOp) : NativeEntityProcessor(theCompiler), op(theOp) {}
+
+	bool IsSupported(dfx::generator::Entity const &entity) const override;
+	void WriteCode(std::ostream &f, dfx::generator::Entity const &entity) const override;
+};
+
+
+// decide
+
+class Decide : public NativeEntityProcessor {
+
+public:
+
+	Decide(NativeCompiler *theCompiler) : NativeEntityProcessor(theCompiler) {}
+
+	bool IsSupported(dfx::generator::Entity const &entity) const override;
+	void WriteCode(std::ostream &f, dfx::generator::Entity const &entity) const override;
+};
+
+
+// delay
+
+class Delay : public NativeEntityProcessor {
+
+public:
+
+	Delay(NativeCompiler *theCompiler) : NativeEntityProcessor(theCompiler) {}
+
+	bool IsSupported(dfx::generator::Entity const &entity) const override;
+	void WriteCode(std::ostream &f, dfx::generator::Entity const &entity) const override;
+};
+
+}
@@ -0,0 +1,55 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Native code emission for operators with an arbitrary number of operands.
+
+*/
+
+#include "../global.h"
+#include "entities.h"
+
+namespace native_entities {
+
+	bool FlatOperator::IsSupported(dfx::generator::Entity const &entity) const
+	{
+		int numberOfOutputs = (int)entity.outputs.size();
+		return numberOfOutputs > 0 && (int)entity.inputs.size() % numberOfOutputs == 0 && HasNativeTypes(*compiler, entity);
+	}
+
+	void FlatOperator::WriteCode(std::ostream &f, dfx::generator::Entity const &entity) const
+	{
+		int numberOfOutputs = (int)entity.outputs.size();
+		int numberOfOperands = (int)entity.inputs.size() / numberOfOutputs;
+
+		for (int i = 0; i < numberOfOutputs; ++i) {
+
+			std::string typeName = GetNativeTypeName(entity.outputs[i].type);
+			std::string name = compiler->WriteOutputDeclaration(f, entity, i);
+			f << typeName << "(" << defaultValue << ");\n";
+
+			for (int j = 0; j < numberOfOperands; ++j)
+				f << "\t" << name << " = " << name << " " << op << " " << compiler->GetInputExpression(entity, numberOfOperands * i + j) << ";\n";
+
+			compiler->WriteOutputStore(f, entity, i);
+		}
+	}
+}
@@ -0,0 +1,528 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Base functionality of the native simulation backend.
+
+*/
+
+#include "global.h"
+
+#include "native.h"
+#include "entities/entities.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#endif
+
+using dfx::generator::Entity;
+using dfx::types::TypeDescription;
+
+//
+// Helpers
+//
+
+std::string GetNativeTypeName(TypeDescription const &type)
+{
+	switch (type.GetClass()) {
+
+		case TypeDescription::Boolean:
+			return "bool";
+
+		case TypeDescription::Int32:
+			return "std::int32_t";
+
+		case TypeDescription::Int64:
+			return "std::int64_t";
+
+		case TypeDescription::Double:
+			return "double";
+
+		default:
+			return "";
+	}
+}
+
+bool HasNativeTypes(NativeCompiler const &compiler, Entity const &entity)
+{
+	for (auto const &output : entity.outputs)
+		if (GetNativeTypeName(output.type).empty())
+			return false;
+
+	for (int i = 0; i < (int)entity.inputs.size(); ++i)
+		if (GetNativeTypeName(compiler.GetInputType(entity, i)).empty())
+			return false;
+
+	return true;
+}
+
+// Returns an exact C++ literal for the given value or an empty string if
+// there is none.
+static std::string GetLiteral(TypeDescription const &type, void const *address)
+{
+	char buffer[64];
+
+	switch (type.GetClass()) {
+
+		case TypeDescription::Boolean:
+			return *static_cast<bool const *>(address) ? "true" : "false";
+
+		case TypeDescription::Int32:
+			std::snprintf(buffer, sizeof(buffer), "((std::int32_t)0x%08" PRIx32 "u)", (std::uint32_t)*static_cast<std::int32_t const *>(address));
+			return buffer;
+
+		case TypeDescription::Int64:
+			std::snprintf(buffer, sizeof(buffer), "((std::int64_t)0x%016" PRIx64 "ull)", (std::uint64_t)*static_cast<std::int64_t const *>(address));
+			return buffer;
+
+		case TypeDescription::Double: {
+
+			double value = *static_cast<double const *>(address);
+			if (!std::isfinite(value))
+				return "";
+
+			// Hexadecimal floating-point literals are exact.
+			std::snprintf(buffer, sizeof(buffer), "%a", value);
+			return buffer;
+		}
+
+		default:
+			return "";
+	}
+}
+
+// Returns the C++ type name for the value type of a group of the register
+// bank or an empty string if the type is not supported by native code.
+static std::string GetNativeTypeName(std::type_index const &type)
+{
+	if (type == typeid(bool))
+		return "bool";
+	else if (type == typeid(std::int32_t))
+		return "std::int32_t";
+	else if (type == typeid(std::int64_t))
+		return "std::int64_t";
+	else if (type == typeid(double))
+		return "double";
+	else
+		return "";
+}
+
+
+//
+// NativeCompiler::Configuration
+//
+
+NativeCompiler::Configuration::Configuration() :
+	compiler("c++"),
+	flags("-std=c++17 -O2 -shared -fPIC -fwrapv -ffp-contract=off"),
+	workingDirectory()
+{
+	if (char const *cxx = std::getenv("CXX"))
+		compiler = cxx;
+}
+
+
+//
+// NativeCompiler
+//
+
+NativeCompiler::NativeCompiler(Configuration const &theConfiguration /* = Configuration() */) :
+	configuration(theConfiguration),
+	entityProcessors(),
+	valueIndices(),
+	values(),
+	localValues(),
+	currentProgram(nullptr),
+	currentBlock(0)
+{
+	entityProcessors["plus"] = std::make_unique<native_entities::FlatOperator>(this, "+", "0");
+	entityProcessors["times"] = std::make_unique<native_entities::FlatOperator>(this, "*", "1");
+	entityProcessors["or"] = std::make_unique<native_entities::FlatOperator>(this, "||", "false");
+	entityProcessors["and"] = std::make_unique<native_entities::FlatOperator>(this, "&&", "true");
+	entityProcessors["xor"] = std::make_unique<native_entities::FlatOperator>(this, "!=", "false");
+
+	entityProcessors["equal"] = std::make_unique<native_entities::Compare>(this, "==");
+	entityProcessors["not_equal"] = std::make_unique<native_entities::Compare>(this, "!=");
+	entityProcessors["less"] = std::make_unique<native_entities::Compare>(this, "<");
+	entityProcessors["less_equal"] = std::make_unique<native_entities::Compare>(this, "<=");
+
+	entityProcessors["negate"] = std::make_unique<native_entities::UnaryOperator>(this, "-");
+	entityProcessors["not"] = std::make_unique<native_entities::UnaryOperator>(this, "!");
+
+	entityProcessors["decide"] = std::make_unique<native_entities::Decide>(this);
+	entityProcessors["delay"] = std::make_unique<native_entities::Delay>(this);
+}
+
+NativeCompiler::~NativeCompiler()
+{
+}
+
+int NativeCompiler::GetValueIndex(void *address)
+{
+	auto it = valueIndices.find(address);
+	if (it != valueIndices.end())
+		return it->second;
+
+	int index = (int)values.size();
+	values.push_back(address);
+	valueIndices[address] = index;
+
+	return index;
+}
+
+NativeEntityProcessor const *NativeCompiler::GetProcessor(Entity const &entity) const
+{
+	auto it = entityProcessors.find(entity.className);
+	if (it == entityProcessors.end() || !it->second->IsSupported(entity))
+		return nullptr;
+
+	return it->second.get();
+}
+
+TypeDescription NativeCompiler::GetInputType(Entity const &entity, int index) const
+{
+	return entity.block->GetInputPins()[index]->GetDrivingPin()->GetType();
+}
+
+std::string NativeCompiler::GetInputExpression(Entity const &entity, int index)
+{
+	// The generated code only reads through this address.
+	auto *pin = const_cast<dfx::backend::OutputPinBase *>(entity.block->GetInputPins()[index]->GetDrivingPin());
+	auto type = pin->GetType();
+
+	if (pin->GetOwner()->GetClassName() == "constant") {
+
+		std::string literal = GetLiteral(type, pin->GetValueAddress());
+		if (!literal.empty())
+			return literal;
+	}
+
+	int valueIndex = GetValueIndex(pin->GetValueAddress());
+
+	if (localValues.count(valueIndex) != 0)
+		return "n" + std::to_string(valueIndex);
+	else
+		return "(*(" + GetNativeTypeName(type) + " const *)v[" + std::to_string(valueIndex) + "])";
+}
+
+int NativeCompiler::GetNumberOfInstructions() const
+{
+	// Blocks that call Evaluate() have no instructions of their own.
+	if (currentProgram->CallsEvaluate(currentBlock))
+		return 0;
+
+	return currentProgram->GetNumberOfInstructions(currentBlock);
+}
+
+std::string NativeCompiler::GetInstructionInputExpression(int instruction, int input, TypeDescription const &type)
+{
+	// The generated code only reads through this address.
+	void *address = const_cast<void *>(currentProgram->GetInstruction(currentBlock, instruction).inputs[input]);
+
+	return "(*(" + GetNativeTypeName(type) + " const *)v[" + std::to_string(GetValueIndex(address)) + "])";
+}
+
+std::string NativeCompiler::WriteOutputDeclaration(std::ostream &f, Entity const &entity, int index)
+{
+	int valueIndex = GetValueIndex(entity.block->GetOutputPins()[index]->GetValueAddress());
+	localValues.insert(valueIndex);
+
+	std::string name = "n" + std::to_string(valueIndex);
+	f << "\t" << GetNativeTypeName(entity.outputs[index].type) << " " << name << " = ";
+
+	return name;
+}
+
+void NativeCompiler::WriteOutputStore(std::ostream &f, Entity const &entity, int index)
+{
+	int valueIndex = GetValueIndex(entity.block->GetOutputPins()[index]->GetValueAddress());
+	f << "\t*(" << GetNativeTypeName(entity.outputs[index].type) << " *)v[" << valueIndex << "] = n" << valueIndex << ";\n";
+}
+
+bool NativeCompiler::WriteComponent(std::ostream &f, std::string const &functionName, dfx::backend::Component const &component)
+{
+	dfx::generator::Instance instance(0, "native", "", nullptr);
+
+	std::vector<NativeEntityProcessor const *> processors;
+	bool anySupported = false;
+
+	currentProgram = &component.program;
+	currentBlock = 0;
+
+	for (auto *block : component.schedule) {
+
+		instance.entities.emplace_back(&instance, block);
+		processors.push_back(GetProcessor(instance.entities.back()));
+		anySupported = anySupported || (processors.back() != nullptr);
+		++currentBlock;
+	}
+
+	if (!anySupported)
+		return false;
+
+	valueIndices.clear();
+	values.clear();
+	localValues.clear();
+
+	f << "DFX_EXPORT void " << functionName << "(Context const *ctx)\n";
+	f << "{\n";
+	f << "\tvoid *const *v = ctx->values;\n";
+
+	// Consecutive blocks without native implementation are executed by a
+	// single call into the bytecode engine.
+	int runStart = -1;
+	int index = 0;
+
+	for (auto const &entity : instance.entities) {
+
+		auto const *processor = processors[index];
+		currentBlock = index;
+
+		if (processor == nullptr) {
+
+			if (runStart < 0)
+				runStart = index;
+		}
+		else {
+
+			if (runStart >= 0) {
+
+				f << "\n\tctx->execute(ctx->program, " << runStart << ", " << index << ");\n";
+				runStart = -1;
+			}
+
+			f << "\n\t// " << entity.className << " '" << entity.block->GetFullName() << "'\n";
+			processor->WriteCode(f, entity);
+		}
+
+		++index;
+	}
+
+	if (runStart >= 0)
+		f << "\n\tctx->execute(ctx->program, " << runStart << ", " << index << ");\n";
+
+	f << "}\n\n";
+
+	return true;
+}
+
+bool NativeCompiler::WriteStep(std::ostream &f, std::string const &functionName, dfx::backend::RegisterBank const &bank, int group) const
+{
+	std::string typeName = GetNativeTypeName(bank.GetGroupType(group));
+	auto ranges = bank.GetOwnerRanges(group);
+
+	if (typeName.empty() || ranges.empty())
+		return false;
+
+	// Same as RegisterBank::Group::StepOwners() with the registers unrolled.
+	f << "DFX_EXPORT void " << functionName << "(StepContext const *ctx)\n";
+	f << "{\n";
+	f << "\t" << typeName << " *s = (" << typeName << " *)ctx->states;\n";
+	f << "\tvoid const *const *in = ctx->inputs;\n";
+	f << "\tbool changed;\n";
+
+	for (int k = 0; k < (int)ranges.size(); ++k) {
+
+		f << "\n\tchanged = false;\n";
+
+		for (int i = ranges[k].first; i < ranges[k].second; ++i) {
+
+			f << "\tif (s[" << i << "] != *(" << typeName << " const *)in[" << i << "]) {\n";
+			f << "\t\ts[" << i << "] = *(" << typeName << " const *)in[" << i << "];\n";
+			f << "\t\tchanged = true;\n";
+			f << "\t}\n";
+		}
+
+		f << "\t++ctx->activities[" << k << "]->steps;\n";
+		f << "\tif (changed) {\n";
+		f << "\t\t++ctx->activities[" << k << "]->changes;\n";
+		f << "\t\tctx->setDirty(ctx->blocks[" << k << "]);\n";
+		f << "\t}\n";
+	}
+
+	f << "}\n\n";
+
+	return true;
+}
+
+void NativeCompiler::Compile(dfx::Simulator &simulator, std::basic_ostream<char> &os)
+{
+#if defined(_WIN32)
+
+	// Building and loading the model has only been done with GCC and Clang.
+	(void)simulator;
+	(void)os;
+	throw dfx::design_error("NativeCompiler: the native backend is not supported on Windows.");
+
+#else
+
+	os << std::endl << " --- Native compiler --- " << std::endl << std::endl;
+
+	if (simulator.GetOptions().engine != dfx::Simulator::Engine::Bytecode)
+		throw dfx::design_error("NativeCompiler: the simulator must use 'Simulator::Engine::Bytecode'.");
+
+	if (simulator.GetOptions().lanes != 1 || simulator.GetOptions().packedBooleans)
+		throw dfx::design_error("NativeCompiler: simulation with several lanes or packed booleans is not supported.");
+
+	fs::path directory = configuration.workingDirectory.empty() ? fs::temp_directory_path() / "oddf_native" : fs::path(configuration.workingDirectory);
+	fs::create_directories(directory);
+
+	// Files in the default directory are only kept to diagnose a failed build.
+	bool keepFiles = !configuration.workingDirectory.empty();
+	auto removeFile = [keepFiles](std::string const &path) {
+
+		std::error_code error;
+		if (!keepFiles)
+			fs::remove(path, error);
+	};
+
+	static std::atomic<int> modelCounter(0);
+	std::string baseName = "oddf_model_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + "_" + std::to_string(modelCounter++);
+
+	std::string sourcePath = (directory / (baseName + ".cpp")).string();
+	std::string libraryPath = (directory / (baseName + ".so")).string();
+	std::string logPath = (directory / (baseName + ".log")).string();
+
+	struct NativeComponent {
+
+		dfx::backend::Program *program;
+		std::string functionName;
+		std::vector<void *> values;
+	};
+
+	std::vector<NativeComponent> nativeComponents;
+
+	struct NativeStep {
+
+		int group;
+		std::string functionName;
+	};
+
+	auto &bank = simulator.GetRegisterBank();
+	std::vector<NativeStep> nativeSteps;
+
+	os << "Writing '" << sourcePath << "'... " << std::endl;
+
+	{
+		std::ofstream f(sourcePath);
+
+		f << "// Generated by the ODDF native compiler. Do not edit.\n\n";
+		f << "#include <cstdint>\n\n";
+		f << "struct Context {\n\n";
+		f << "\tvoid *const *values;\n";
+		f << "\tvoid const *program;\n";
+		f << "\tvoid (*execute)(void const *program, int firstBlock, int lastBlock);\n";
+		f << "};\n\n";
+		f << "struct Activity {\n\n";
+		f << "\tstd::uint64_t steps;\n";
+		f << "\tstd::uint64_t changes;\n";
+		f << "};\n\n";
+		f << "struct StepContext {\n\n";
+		f << "\tvoid *states;\n";
+		f << "\tvoid const *const *inputs;\n";
+		f << "\tActivity *const *activities;\n";
+		f << "\tvoid *const *blocks;\n";
+		f << "\tvoid (*setDirty)(void *block);\n";
+		f << "};\n\n";
+		f << "#define DFX_EXPORT extern \"C\" __attribute__((visibility(\"default\")))\n\n";
+
+		for (auto &component : simulator.GetComponents()) {
+
+			// Wavefront components are evaluated in parts by several threads.
+			if (component.program.IsEmpty() || !component.wavefrontLevels.empty())
+				continue;
+
+			std::string functionName = "dfx_component_" + std::to_string(nativeComponents.size());
+
+			if (WriteComponent(f, functionName, component))
+				nativeComponents.push_back({ &component.program, functionName, values });
+		}
+
+		for (int group = 0; group < bank.GetNumberOfGroups(); ++group) {
+
+			std::string functionName = "dfx_step_" + std::to_string(nativeSteps.size());
+
+			if (WriteStep(f, functionName, bank, group))
+				nativeSteps.push_back({ group, functionName });
+		}
+
+		if (!f)
+			throw dfx::design_error("NativeCompiler: could not write '" + sourcePath + "'.");
+	}
+
+	os << "Generated " << nativeComponents.size() << " of " << simulator.GetComponents().size() << " components." << std::endl;
+	os << "Generated " << nativeSteps.size() << " of " << bank.GetNumberOfGroups() << " step groups." << std::endl;
+
+	if (nativeComponents.empty() && nativeSteps.empty()) {
+
+		removeFile(sourcePath);
+		return;
+	}
+
+	std::string command = configuration.compiler + " " + configuration.flags + " -o \"" + libraryPath + "\" \"" + sourcePath + "\" > \"" + logPath + "\" 2>&1";
+
+	os << "Compiling... " << std::endl;
+
+	if (std::system(command.c_str()) != 0)
+		throw dfx::design_error("NativeCompiler: compilation failed. See '" + logPath + "' for details.");
+
+	removeFile(sourcePath);
+	removeFile(logPath);
+
+	os << "Loading '" << libraryPath << "'... " << std::endl;
+
+	void *handle = dlopen(libraryPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (handle == nullptr)
+		throw dfx::design_error("NativeCompiler: could not load '" + libraryPath + "': " + dlerror());
+
+	// The loaded library stays mapped after its file is removed.
+	removeFile(libraryPath);
+
+	std::shared_ptr<void> library(handle, [](void *handle) { dlclose(handle); });
+
+	auto lookup = [handle](std::string const &name) { return dlsym(handle, name.c_str()); };
+
+	for (auto &nativeComponent : nativeComponents) {
+
+		void *function = lookup(nativeComponent.functionName);
+		if (function == nullptr)
+			throw dfx::design_error("NativeCompiler: function '" + nativeComponent.functionName + "' is missing in '" + libraryPath + "'.");
+
+		nativeComponent.program->SetNative(reinterpret_cast<dfx::backend::NativeFunction>(function), nativeComponent.values, library);
+	}
+
+	for (auto const &nativeStep : nativeSteps) {
+
+		void *function = lookup(nativeStep.functionName);
+		if (function == nullptr)
+			throw dfx::design_error("NativeCompiler: function '" + nativeStep.functionName + "' is missing in '" + libraryPath + "'.");
+
+		bank.SetNativeStep(nativeStep.group, reinterpret_cast<dfx::backend::NativeStepFunction>(function), library);
+	}
+
+	os << "Done." << std::endl;
+
+#endif
+}
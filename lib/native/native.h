@@ -0,0 +1,140 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Main include for the native simulation backend. The backend emits a C++
+	translation unit with one function per component of the simulator and
+	one per group of the register bank, builds it with the host compiler and
+	loads the result. Blocks without a native implementation are executed
+	through the bytecode engine from within the generated code. Delay lines
+	and registers with dynfix states are stepped by the register bank.
+
+	The model is built with a GCC-compatible compiler and loaded with
+	dlopen(). The backend is not available on Windows.
+
+*/
+
+#pragma once
+
+#include "global.h"
+
+class NativeCompiler;
+
+class NativeEntityProcessor {
+
+protected:
+
+	NativeCompiler *compiler;
+
+public:
+
+	NativeEntityProcessor(NativeCompiler *theCompiler) : compiler(theCompiler) {}
+	virtual ~NativeEntityProcessor() {}
+
+	// Indicates whether native code can be generated for the given entity.
+	virtual bool IsSupported(dfx::generator::Entity const &entity) const = 0;
+
+	virtual void WriteCode(std::ostream &f, dfx::generator::Entity const &entity) const = 0;
+};
+
+
+class NativeCompiler {
+
+public:
+
+	struct Configuration {
+
+		// Command that invokes the host compiler. Defaults to the CXX
+		// environment variable or 'c++'.
+		std::string compiler;
+
+		// Flags that make the compiler produce a shared library. The defaults
+		// are for GCC and Clang.
+		std::string flags;
+
+		// Directory that receives the generated sources and libraries.
+		// Defaults to a sub-directory of the system's temporary directory,
+		// from which the files are removed unless the build fails. Files in
+		// a directory given here are kept.
+		std::string workingDirectory;
+
+		Configuration();
+	};
+
+private:
+
+	Configuration configuration;
+
+	std::unordered_map<std::string, std::unique_ptr<NativeEntityProcessor>> entityProcessors;
+
+	// Value table and values cached in local variables of the component
+	// function currently being written.
+	std::unordered_map<void *, int> valueIndices;
+	std::vector<void *> values;
+	std::unordered_set<int> localValues;
+
+	// Program and index in the schedule of the block currently being
+	// written.
+	dfx::backend::Program const *currentProgram;
+	int currentBlock;
+
+	int GetValueIndex(void *address);
+
+	NativeEntityProcessor const *GetProcessor(dfx::generator::Entity const &entity) const;
+	bool WriteComponent(std::ostream &f, std::string const &functionName, dfx::backend::Component const &component);
+	bool WriteStep(std::ostream &f, std::string const &functionName, dfx::backend::RegisterBank const &bank, int group) const;
+
+public:
+
+	NativeCompiler(Configuration const &theConfiguration = Configuration());
+	~NativeCompiler();
+
+	// Generates, builds and loads native code for the components and the
+	// register bank of the simulator. The simulator must use the bytecode
+	// engine.
+	void Compile(dfx::Simulator &simulator, std::basic_ostream<char> &os);
+
+	// Returns a C++ expression for the value driving the given input.
+	std::string GetInputExpression(dfx::generator::Entity const &entity, int index);
+
+	// Returns the type of the value driving the given input.
+	dfx::types::TypeDescription GetInputType(dfx::generator::Entity const &entity, int index) const;
+
+	// Returns the number of bytecode instructions of the current block and a
+	// C++ expression of the given type for an input of one of them, e.g.
+	// the state a delay loads into its output.
+	int GetNumberOfInstructions() const;
+	std::string GetInstructionInputExpression(int instruction, int input, dfx::types::TypeDescription const &type);
+
+	// Writes the declaration of the local variable that holds the given
+	// output followed by ' = ' and returns its name.
+	std::string WriteOutputDeclaration(std::ostream &f, dfx::generator::Entity const &entity, int index);
+
+	// Writes the local variable of the given output back to the output pin.
+	void WriteOutputStore(std::ostream &f, dfx::generator::Entity const &entity, int index);
+};
+
+
+// Returns the C++ type name for the given type or an empty string if the type is not supported by native code.
+std::string GetNativeTypeName(dfx::types::TypeDescription const &type);
+
+// Tests if all inputs and outputs of the entity have types that are supported by native code.
+bool HasNativeTypes(NativeCompiler const &compiler, dfx::generator::Entity const &entity);
@@ -29,6 +29,7 @@
 
 #include "node.h"
 #include "hierarchy.h"
+#include "generator/properties.h"
 
 namespace dfx {
 
@@ -51,8 +52,12 @@ BlockBase::BlockBase(char const *className) :
 	className(className),
 	hierarchyLevel(Design::GetCurrent().GetHierarchy().GetCurrentLevel()),
 	mark(false),
+	level(0),
 	component(nullptr),
 	componentNext(nullptr),
+	scheduleIndex(0),
+	excluded(false),
+	blockIndex(0),
 	inputPins(),
 	outputPins()
 {
@@ -65,8 +70,12 @@ BlockBase::BlockBase(char const *className, std::string const &tag) :
 	className(className),
 	hierarchyLevel(Design::GetCurrent().GetHierarchy().GetCurrentLevel()),
 	mark(false),
+	level(0),
 	component(nullptr),
 	componentNext(nullptr),
+	scheduleIndex(0),
+	excluded(false),
+	blockIndex(0),
 	inputPins(),
 	outputPins()
 {
@@ -153,6 +162,11 @@ IStep *BlockBase::GetStep()
 	return nullptr;
 }
 
+bool BlockBase::IsObservable() const
+{
+	return false;
+}
+
 void BlockBase::Simplify()
 {
 }
@@ -185,15 +199,26 @@ bool BlockBase::CanRemove() const
 	return true;
 }
 
-void BlockBase::SetDirty()
+bool BlockBase::Lower(ProgramBuilder &)
 {
-	if (component)
-		component->outdated = true;
+	return false;
 }
 
-/*
+bool BlockBase::SetLanes(LaneLayout const &layout)
+{
+	return layout.IsTrivial();
+}
+
+void BlockBase::SetDirty()
+{
+	if (component) {
 
-This is never used
+		component->outdated = true;
+
+		if (!component->pending.empty())
+			component->pending[scheduleIndex] = 1;
+	}
+}
 
 std::size_t BlockBase::GetHash() const
 {
@@ -202,26 +227,30 @@ std::size_t BlockBase::GetHash() const
 	hash_combine(hash, className);
 	hash_combine(hash, inputPins.size());
 	hash_combine(hash, outputPins.size());
-	
-	std::string temp;
 
 	for (auto *output : outputPins)
 		hash_combine(hash, output->GetType().GetHash());
 
-	for (auto *input : inputPins) {
-
-		auto driver = input->GetDrivingPin();
-
-		if (driver)
-			hash_combine(hash, driver->GetType().GetHash());
-		else
-			hash_combine(hash, 0);
-	}
+	for (auto *input : inputPins)
+		hash_combine(hash, input->GetDrivingPin());
 
 	return hash;
 }
 
-*/
+bool BlockBase::IsEquivalent(BlockBase const &) const
+{
+	return false;
+}
+
+bool BlockBase::HasEqualProperties(BlockBase const &other) const
+{
+	dfx::generator::Properties properties, otherProperties;
+
+	GetProperties(properties);
+	other.GetProperties(otherProperties);
+
+	return properties == otherProperties;
+}
 
 }
 }
@@ -43,18 +43,61 @@ namespace backend {
 
 class Component;
 class InputPinBase;
+template<typename T> class InputPin;
 class OutputPinBase;
+class ProgramBuilder;
+class RegisterBank;
+class StateReader;
+class StateWriter;
+struct LaneLayout;
 
 //
 // IStep: interface for clocked blocks.
 //
 
+// Number of calls to Step() and of those calls that changed the state.
+struct StepActivity {
+
+	std::uint64_t steps;
+	std::uint64_t changes;
+
+	StepActivity() : steps(0), changes(0) {}
+};
+
 class IStep {
 
 public:
 
 	virtual void Step() = 0;
 	virtual void AsyncReset() = 0;
+
+	// Writes and reads the complete clocked state of the block, i.e. the state
+	// taken over by Step() (see Simulator::SaveState()).
+	virtual void SaveState(StateWriter &writer) const = 0;
+	virtual void RestoreState(StateReader &reader) = 0;
+
+	// Returns the activity counters of blocks that record them or nullptr.
+	// Every new simulator resets the counters.
+	virtual StepActivity *GetActivity()
+	{
+		return nullptr;
+	}
+
+	// Hands the state over to the register bank of the simulator, which then
+	// steps it together with the states of other blocks. Returns 'false' if
+	// the block steps itself.
+	virtual bool UseRegisterBank(RegisterBank &)
+	{
+		return false;
+	}
+
+	// Returns the clock enable of the block or nullptr if Step() takes over
+	// the inputs in every clock cycle. While the enable is low, Step() must
+	// not read any other input (see Simulator::Options::clockEnableGating).
+	virtual InputPin<bool> const *GetEnableInput() const
+	{
+		return nullptr;
+	}
 };
 
 
@@ -64,10 +107,6 @@ public:
 
 class BlockBase {
 
-public:
-
-	using source_blocks_t = std::unordered_set<BlockBase *>;
-
 private:
 
 	std::string name;
@@ -77,8 +116,17 @@ private:
 private:
 
 	bool mark;
+	int level;
 	Component *component;
 	BlockBase *componentNext;
+	int scheduleIndex;
+
+	// Set if the simulator does not schedule the block because its inputs are
+	// constant or its outputs are not observed (see Simulator::Options::optimiseExecutionGraph).
+	bool excluded;
+
+	// Position in the list of blocks of the simulator
+	int blockIndex;
 
 	friend class dfx::Simulator;
 
@@ -99,6 +147,9 @@ protected:
 	virtual std::string GetInputPinName(int index) const;
 	virtual std::string GetOutputPinDescription(int index, int &groupIndex, int &busSize, int &busIndex) const;
 
+	// Compares the properties of the block with those of 'other'. For use in IsEquivalent().
+	bool HasEqualProperties(BlockBase const &other) const;
+
 public:
 
 	BlockBase(char const *className);
@@ -124,8 +175,17 @@ public:
 	// Evaluates this block and updates the values of its output nodes.
 	virtual void Evaluate() = 0;
 
-	// Returns all input blocks whose results are required for the evaluation of the current block. Used by the simulator to determine the evaluation order.
-	virtual source_blocks_t GetSourceBlocks() const = 0;
+	// Emits bytecode instructions with the same effect as Evaluate(). Returns 'false' if the block does not support this, in which case the simulator calls Evaluate() instead.
+	virtual bool Lower(ProgramBuilder &builder);
+
+	// Prepares the block for the simulation of several independent lanes with the given value layout (see Simulator::Options::lanes). Blocks that keep state or exchange data with the user keep one copy per lane, and their Evaluate() and Step() process all lanes. Returns 'false' if the block does not support this. Called by every simulator, also with the trivial layout. Stateless blocks that are lowered need not implement this.
+	virtual bool SetLanes(LaneLayout const &layout);
+
+	// Indicates whether the evaluation of the current block requires the result of the block driving the given input pin. Used by the simulator to determine the evaluation order.
+	virtual bool IsSourcePin(InputPinBase const &pin) const = 0;
+
+	// Calls 'visit' with the driving block of every input pin for which IsSourcePin() returns 'true'. A block driving several such pins is visited once per pin. Does not allocate.
+	template<typename visitorT> void ForEachSourceBlock(visitorT &&visit) const;
 
 	// Returns an IStep interface if the block is clocked or nullptr otherwise.
 	virtual IStep *GetStep();
@@ -133,6 +193,9 @@ public:
 	// Indicates whether Evaluate() should be called during simulation.
 	virtual bool CanEvaluate() const = 0;
 
+	// Indicates whether the user reads the inputs of the block other than through Step(), like the values of a probe. Together with the clocked blocks, these are the blocks the simulator evaluates the design for. Default implementation returns 'false'.
+	virtual bool IsObservable() const;
+
 	// Called once by the simulator to remove 'identity' blocks
 	virtual void Simplify();
 
@@ -145,15 +208,13 @@ public:
 
 	void SetDirty();
 
-	/*
-
-	This is never used.
-
-	// Returns a hash based on the the class name, the number of inputs and outputs and their data types, and the properties.
+	// Returns a hash based on the class name, the number of inputs and outputs, the data types of the outputs and the pins driving the inputs.
 	// Can be overidden in a derived class to include additional parameters in the computation.
 	virtual std::size_t GetHash() const;
 
-	*/
+	// Indicates whether the block computes the same outputs as 'other', which is of the same class and has the same hash, the same output types and its inputs driven by the same pins. Used by the simulator to merge duplicate blocks (see Simulator::Options::mergeEquivalentBlocks).
+	// Default implementation returns 'false'. Blocks with side effects must not override it.
+	virtual bool IsEquivalent(BlockBase const &other) const;
 };
 
 }
@@ -37,14 +37,9 @@ private:
 	std::list<InputPin<bool>> bitInputs;
 	OutputPin<T> output;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		for (auto &pin : bitInputs)
-			blocks.insert(pin.GetDrivingBlock());
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -65,7 +60,7 @@ private:
 			value <<= 1;
 		}
 
-		output.value = static_cast<T>(result);
+		*output.valuePointer = static_cast<T>(result);
 	}
 
 	std::string GetInputPinName(int index) const override
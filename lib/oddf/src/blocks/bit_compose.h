@@ -40,7 +40,7 @@ template<> node<dynfix> BitCompose(dynfix const &, bus_access<bool> const &);
 
 template<typename T> node<T> inline BitCompose(node<T> const &templateNode, bus_access<bool> const &bits)
 {
-	return BitCompose<T>(templateNode.GetDriver()->value, bits);
+	return BitCompose<T>(*templateNode.GetDriver()->valuePointer, bits);
 }
 
 template<typename T> node<typename types::TypeTraits<T>::internalType> inline BitCompose(bus_access<bool> const &bits)
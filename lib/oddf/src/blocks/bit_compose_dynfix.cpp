@@ -38,14 +38,9 @@ private:
 	std::list<InputPin<bool>> bitInputs;
 	OutputPin<dynfix> output;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		for (auto &pin : bitInputs)
-			blocks.insert(pin.GetDrivingBlock());
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -59,15 +54,15 @@ private:
 		for (auto &input : bitInputs) {
 
 			if (input.GetValue())
-				output.value.data[position / 32] |= (1 << (position % 32));
+				output.valuePointer->data[position / 32] |= (1 << (position % 32));
 			else
-				output.value.data[position / 32] &= ~(1 << (position % 32));
+				output.valuePointer->data[position / 32] &= ~(1 << (position % 32));
 
 			++position;
 		}
 
 		// TODO: actually we only have to do the sign extension.
-		output.value.OverflowWrapAround();
+		output.valuePointer->OverflowWrapAround();
 	}
 
 	std::string GetInputPinName(int index) const override
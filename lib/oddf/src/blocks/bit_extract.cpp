@@ -41,9 +41,9 @@ private:
 	InputPin<T> valueInput;
 	std::list<OutputPin<bool>> outputs;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t({ valueInput.GetDrivingBlock() });
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -51,6 +51,12 @@ private:
 		return true;
 	}
 
+	bool IsEquivalent(BlockBase const &other) const override
+	{
+		auto &block = static_cast<bit_extract_block const &>(other);
+		return firstBitIndex == block.firstBitIndex && lastBitIndex == block.lastBitIndex;
+	}
+
 	void Evaluate() override
 	{
 		std::uint64_t value = (std::uint64_t)valueInput.GetValue();
@@ -60,11 +66,35 @@ private:
 
 		for (auto &output : outputs) {
 
-			output.value = (value & (1ull << position)) != 0;
+			*output.valuePointer = (value & (1ull << position)) != 0;
 			position += increment;
 		}
 	}
 
+	static void Execute(Instruction const &instruction)
+	{
+		bool *output = static_cast<bool *>(instruction.output);
+		T const *value = static_cast<T const *>(instruction.inputs[0]);
+
+		std::uint64_t mask = 1ull << instruction.parameters[0];
+
+		instruction.layout.SetBooleans(output, [&](int lane) { return ((std::uint64_t)value[lane] & mask) != 0; });
+	}
+
+	bool Lower(ProgramBuilder &builder) override
+	{
+		int position = firstBitIndex;
+		int increment = firstBitIndex < lastBitIndex ? 1 : -1;
+
+		for (auto &output : outputs) {
+
+			builder.Emit(&Execute, output.valuePointer, { &valueInput.GetValue() }, { position });
+			position += increment;
+		}
+
+		return true;
+	}
+
 	std::string GetInputPinName(int index) const override
 	{
 		if (index == 0)
@@ -42,9 +42,9 @@ private:
 	InputPin<dynfix> valueInput;
 	std::list<OutputPin<bool>> outputs;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t({ valueInput.GetDrivingBlock() });
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -60,9 +60,31 @@ private:
 
 		for (auto &output : outputs) {
 
-			output.value = (value.data[position / 32] & (1 << (position % 32))) != 0;
+			*output.valuePointer = (value.data[position / 32] & (1 << (position % 32))) != 0;
+			position += increment;
+		}
+	}
+
+	static void Execute(Instruction const &instruction)
+	{
+		bool *output = static_cast<bool *>(instruction.output);
+		dynfix const *value = static_cast<dynfix const *>(instruction.inputs[0]);
+		int position = instruction.parameters[0];
+
+		instruction.layout.SetBooleans(output, [&](int lane) { return (value[lane].data[position / 32] & (1 << (position % 32))) != 0; });
+	}
+
+	bool Lower(ProgramBuilder &builder) override
+	{
+		int position = firstPosition;
+
+		for (auto &output : outputs) {
+
+			builder.Emit(&Execute, output.valuePointer, { &valueInput.GetValue() }, { position });
 			position += increment;
 		}
+
+		return true;
 	}
 
 	std::string GetOutputPinDescription(int index, int &groupIndex, int &busSize, int &busIndex) const override
@@ -102,7 +124,7 @@ public:
 		valueInput(this, value),
 		outputs()
 	{
-		auto valueTypeDesc = types::GetDescription(value.GetDriver()->value);
+		auto valueTypeDesc = types::GetDescription(*value.GetDriver()->valuePointer);
 
 		int minIndex = -valueTypeDesc.GetFraction();
 		int maxIndex = valueTypeDesc.GetWordWidth() - valueTypeDesc.GetFraction() - 1;
@@ -39,9 +39,9 @@ outputs()
 }
 
 template<typename T>
-BlockBase::source_blocks_t constant_block<T>::GetSourceBlocks() const
+bool constant_block<T>::IsSourcePin(InputPinBase const &) const
 {
-	return source_blocks_t();
+	return false;
 }
 
 template<typename T>
@@ -60,7 +60,7 @@ node<T> constant_block<T>::add_output(T const &constant)
 	outputs.emplace_back(this, constant);
 
 	auto &back = outputs.back();
-	back.value = constant;
+	*back.valuePointer = constant;
 	return back.GetNode();
 }
 
@@ -76,7 +76,7 @@ void FillValuesProperty<bool>(dfx::generator::Properties &properties, std::list<
 {
 	int index = 0;
 	for (auto &output : outputs)
-		properties.SetInt("Constant", index++, output.value ? 1 : 0);
+		properties.SetInt("Constant", index++, *output.valuePointer ? 1 : 0);
 }
 
 template<>
@@ -85,7 +85,7 @@ void FillValuesProperty<dynfix>(dfx::generator::Properties &properties, std::lis
 	int index = 0;
 	for (auto &output : outputs) {
 
-		auto value = output.value;
+		auto value = *output.valuePointer;
 
 		for (int i = 0; i < dynfix::MAX_FIELDS; ++i) {
 			properties.SetInt("Constant", index, i, value.data[i]);
@@ -104,6 +104,50 @@ void constant_block<T>::GetProperties(dfx::generator::Properties &properties) co
 }
 
 
+// merging of equal constants
+
+template<typename T>
+static std::size_t HashConstant(T const &value)
+{
+	return std::hash<T>()(value);
+}
+
+static std::size_t HashConstant(dynfix const &value)
+{
+	return std::hash<std::int32_t>()(value.data[0]);
+}
+
+template<typename T>
+static bool IsSameConstant(T value, T const &other)
+{
+	return types::IsEqual(value, other);
+}
+
+// Distinguishes -0.0 from 0.0.
+static bool IsSameConstant(double value, double const &other)
+{
+	return std::memcmp(&value, &other, sizeof(value)) == 0;
+}
+
+template<typename T>
+std::size_t constant_block<T>::GetHash() const
+{
+	std::size_t hash = BlockBase::GetHash();
+
+	for (auto &output : outputs)
+		hash_combine(hash, HashConstant(*output.valuePointer));
+
+	return hash;
+}
+
+template<typename T>
+bool constant_block<T>::IsEquivalent(BlockBase const &other) const
+{
+	auto &otherOutputs = static_cast<constant_block<T> const &>(other).outputs;
+	return std::equal(outputs.begin(), outputs.end(), otherOutputs.begin(), otherOutputs.end(), [](OutputPin<T> const &lhs, OutputPin<T> const &rhs) { return IsSameConstant(*lhs.valuePointer, *rhs.valuePointer); });
+}
+
+
 // explicit template implementations
 template class constant_block<bool>;
 template class constant_block<std::int32_t>;
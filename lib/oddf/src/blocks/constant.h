@@ -44,12 +44,15 @@ private:
 
 	std::list<backend::OutputPin<T>> outputs;
 
-	source_blocks_t GetSourceBlocks() const override;
+	bool IsSourcePin(InputPinBase const &pin) const override;
 	bool CanEvaluate() const override;
 	void Evaluate() override;
 
 	void GetProperties(dfx::generator::Properties &properties) const override;
 
+	std::size_t GetHash() const override;
+	bool IsEquivalent(BlockBase const &other) const override;
+
 public:
 
 	constant_block();
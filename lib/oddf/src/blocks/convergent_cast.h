@@ -75,12 +75,12 @@ template<typename toT, typename fromT> node<typename types::TypeTraits<toT>::int
 
 template<typename toT, typename fromT> node<toT> inline ConvergentCast(node<toT> const &templateNode, node<fromT> const &node, CastMode castMode = CastMode::WrapAround)
 {
-	return ConvergentCast<toT, fromT>(templateNode.GetDriver()->value, bus<fromT>(node), castMode).first();
+	return ConvergentCast<toT, fromT>(*templateNode.GetDriver()->valuePointer, bus<fromT>(node), castMode).first();
 }
 
 template<typename toT, typename fromT> bus<toT> inline ConvergentCast(node<toT> const &templateNode, bus_access<fromT> const &bus, CastMode castMode = CastMode::WrapAround)
 {
-	return ConvergentCast<toT, fromT>(templateNode.GetDriver()->value, bus, castMode);
+	return ConvergentCast<toT, fromT>(*templateNode.GetDriver()->valuePointer, bus, castMode);
 }
 
 template<typename toT, typename fromT> node<typename types::TypeTraits<toT>::internalType> inline ConvergentCast(node<fromT> const &node, CastMode castMode = CastMode::WrapAround)
@@ -53,19 +53,9 @@ private:
 
 	std::list<Path> paths;
 	
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		blocks.insert(decisionInput.GetDrivingBlock());
-
-		for (auto &path : paths) {
-
-			blocks.insert(path.trueInput.GetDrivingBlock());
-			blocks.insert(path.falseInput.GetDrivingBlock());
-		}
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -73,6 +63,11 @@ private:
 		return true;
 	}
 
+	bool IsEquivalent(BlockBase const &) const override
+	{
+		return true;
+	}
+
 	std::string GetInputPinName(int index) const override
 	{
 		if (index == 0)
@@ -89,15 +84,55 @@ private:
 		if (decisionInput.GetValue()) {
 
 			for (auto &p : paths)
-				p.output.value = p.trueInput.GetValue();
+				*p.output.valuePointer = p.trueInput.GetValue();
 		}
 		else {
 
 			for (auto &p : paths)
-				p.output.value = p.falseInput.GetValue();
+				*p.output.valuePointer = p.falseInput.GetValue();
 		}
 	}
 
+	static void Execute(Instruction const &instruction)
+	{
+		T *output = static_cast<T *>(instruction.output);
+		bool const *decision = static_cast<bool const *>(instruction.inputs[0]);
+		T const *trueValue = static_cast<T const *>(instruction.inputs[1]);
+		T const *falseValue = static_cast<T const *>(instruction.inputs[2]);
+
+		auto const &layout = instruction.layout;
+
+		for (int lane = 0; lane < layout.lanes; ++lane)
+			layout.Set(output, lane, layout.Get(decision, lane) ? layout.Get(trueValue, lane) : layout.Get(falseValue, lane));
+	}
+
+	// Selects 64 packed bool lanes at once.
+	static void ExecuteWords(Instruction const &instruction)
+	{
+		bool *output = static_cast<bool *>(instruction.output);
+		bool const *decision = static_cast<bool const *>(instruction.inputs[0]);
+		bool const *trueValue = static_cast<bool const *>(instruction.inputs[1]);
+		bool const *falseValue = static_cast<bool const *>(instruction.inputs[2]);
+
+		for (int word = 0; word < instruction.layout.GetNumberOfWords(); ++word) {
+
+			std::uint64_t mask = LoadWord(decision, word);
+			StoreWord(output, word, (mask & LoadWord(trueValue, word)) | (~mask & LoadWord(falseValue, word)));
+		}
+	}
+
+	bool Lower(ProgramBuilder &builder) override
+	{
+		Kernel kernel = &Execute;
+		if (std::is_same<T, bool>::value && builder.GetLayout().packedBooleans)
+			kernel = &ExecuteWords;
+
+		for (auto &p : paths)
+			builder.Emit(kernel, p.output.valuePointer, { &decisionInput.GetValue(), &p.trueInput.GetValue(), &p.falseInput.GetValue() });
+
+		return true;
+	}
+
 	std::string GetOutputPinDescription(int index, int &groupIndex, int &busSize, int &busIndex) const override
 	{
 		int length = (int)paths.size();
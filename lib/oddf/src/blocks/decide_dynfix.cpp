@@ -62,19 +62,9 @@ private:
 	std::list<Path> paths;
 	bool allTheSameType;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		blocks.insert(decisionInput.GetDrivingBlock());
-
-		for (auto &path : paths) {
-
-			blocks.insert(path.trueInput.GetDrivingBlock());
-			blocks.insert(path.falseInput.GetDrivingBlock());
-		}
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -98,15 +88,39 @@ private:
 		if (decisionInput.GetValue()) {
 
 			for (auto &p : paths)
-				p.trueInput.GetValue().CopyShiftLeft(p.output.value, p.trueShift);
+				p.trueInput.GetValue().CopyShiftLeft(*p.output.valuePointer, p.trueShift);
 		}
 		else {
 
 			for (auto &p : paths)
-				p.falseInput.GetValue().CopyShiftLeft(p.output.value, p.falseShift);
+				p.falseInput.GetValue().CopyShiftLeft(*p.output.valuePointer, p.falseShift);
 		}
 	}
 
+	static void Execute(Instruction const &instruction)
+	{
+		dynfix *output = static_cast<dynfix *>(instruction.output);
+		bool const *decision = static_cast<bool const *>(instruction.inputs[0]);
+		dynfix const *trueValue = static_cast<dynfix const *>(instruction.inputs[1]);
+		dynfix const *falseValue = static_cast<dynfix const *>(instruction.inputs[2]);
+
+		for (int lane = 0; lane < instruction.layout.lanes; ++lane) {
+
+			if (instruction.layout.Get(decision, lane))
+				trueValue[lane].CopyShiftLeft(output[lane], instruction.parameters[0]);
+			else
+				falseValue[lane].CopyShiftLeft(output[lane], instruction.parameters[1]);
+		}
+	}
+
+	bool Lower(ProgramBuilder &builder) override
+	{
+		for (auto &p : paths)
+			builder.Emit(&Execute, p.output.valuePointer, { &decisionInput.GetValue(), &p.trueInput.GetValue(), &p.falseInput.GetValue() }, { p.trueShift, p.falseShift });
+
+		return true;
+	}
+
 	std::string GetOutputPinDescription(int index, int &groupIndex, int &busSize, int &busIndex) const override
 	{
 		int length = (int)paths.size();
@@ -145,8 +159,8 @@ public:
 
 	node<dynfix> add_path(node<dynfix> const &trueInput, node<dynfix> const &falseInput)
 	{
-		dynfix trueTemplate = types::DefaultFrom(trueInput.GetDriver()->value);
-		dynfix falseTemplate = types::DefaultFrom(falseInput.GetDriver()->value);
+		dynfix trueTemplate = types::DefaultFrom(*trueInput.GetDriver()->valuePointer);
+		dynfix falseTemplate = types::DefaultFrom(*falseInput.GetDriver()->valuePointer);
 
 		bool trueSigned = trueTemplate.IsSigned();
 		int trueWordWidth = trueTemplate.GetWordWidth();
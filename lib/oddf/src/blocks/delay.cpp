@@ -25,37 +25,56 @@
 */
 
 #include "../global.h"
-#include "../simulator_optimisations.h"
 
 namespace dfx {
 namespace backend {
 namespace blocks {
 
+// Copies the states of all lanes to the output values.
+template<typename T>
+static inline void LoadStates(LaneLayout const &layout, T *output, T const *states)
+{
+	for (int lane = 0; lane < layout.lanes; ++lane)
+		types::Copy(output[lane], states[lane]);
+}
+
+static inline void LoadStates(LaneLayout const &layout, bool *output, bool const *states)
+{
+	layout.SetBooleans(output, [&](int lane) { return states[lane]; });
+}
+
 template<typename T> class delay_block : public BlockBase, private IStep {
 
 protected:
 
 	struct Path {
 	
-		T state;
+		// One state per lane. 'state' points to 'storage' or into the
+		// register bank of the simulator.
+		std::unique_ptr<T[]> storage;
+		T *state;
 		InputPin<T> input;
 		OutputPin<T> output;
 
 		Path(BlockBase *block, node<T> const &inputNode, T const &initState) :
-			state(initState),
+			storage(new T[1]),
+			state(storage.get()),
 			input(block, inputNode),
 			output(block, initState)
 		{
+			state[0] = initState;
 		}
 
 	};
 
 	std::list<Path> paths;
 	bool allTheSameType;
+	LaneLayout layout;
+	StepActivity activity;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t();
+		return false;
 	}
 
 	bool CanEvaluate() const override
@@ -66,45 +85,112 @@ protected:
 	void Evaluate() override
 	{
 		for (auto &p : paths)
-			types::Copy(p.output.value, p.state);
+			LoadStates(layout, p.output.valuePointer, p.state);
 	}
 
-	void Step() override
+	static void Execute(Instruction const &instruction)
 	{
-#if defined(DFX_SIMULATOR_DELAY_DIRTY_ON_CHANGE) && (DFX_SIMULATOR_DELAY_DIRTY_ON_CHANGE == 1)
+		LoadStates(instruction.layout, static_cast<T *>(instruction.output), static_cast<T const *>(instruction.inputs[0]));
+	}
 
-		bool changed = false;
+	bool Lower(ProgramBuilder &builder) override
+	{
+		for (auto &p : paths)
+			builder.Emit(&Execute, p.output.valuePointer, { p.state });
 
+		return true;
+	}
+
+	// The states are kept one per lane, also for packed bool values.
+	bool SetLanes(LaneLayout const &theLayout) override
+	{
 		for (auto &p : paths) {
 
-			if (changed || !types::IsEqual(p.state, p.input.GetValue())) {
+			std::unique_ptr<T[]> storage(new T[theLayout.lanes]);
+			std::fill(storage.get(), storage.get() + theLayout.lanes, p.state[0]);
+			p.storage = std::move(storage);
+			p.state = p.storage.get();
+		}
+
+		layout = theLayout;
+		return true;
+	}
+
+	// Indicates whether the given lane takes the next state in this clock cycle.
+	virtual bool IsEnabled(int) const
+	{
+		return true;
+	}
+
+	void Step() override
+	{
+		bool changed = false;
+
+		for (int lane = 0; lane < layout.lanes; ++lane) {
+
+			if (!IsEnabled(lane))
+				continue;
 
-				changed = true;
-				types::Copy(p.state, p.input.GetValue());
+			for (auto &p : paths) {
+
+				T value = p.input.GetValue(layout, lane);
+
+				if (!types::IsEqual(p.state[lane], value)) {
+
+					changed = true;
+					types::Copy(p.state[lane], value);
+				}
 			}
 		}
 
-		if (changed)
+		++activity.steps;
+
+		if (changed) {
+
+			++activity.changes;
 			SetDirty();
+		}
+	}
 
-#elif defined(DFX_SIMULATOR_DELAY_DIRTY_ON_CHANGE) && (DFX_SIMULATOR_DELAY_DIRTY_ON_CHANGE == 0)
+	StepActivity *GetActivity() override
+	{
+		return &activity;
+	}
+
+	// The register bank holds single-lane states only.
+	bool UseRegisterBank(RegisterBank &bank) override
+	{
+		if (!layout.IsTrivial())
+			return false;
+
+		auto const *enableInput = GetEnableInput();
+		bool const *enable = enableInput != nullptr ? &enableInput->GetValue() : nullptr;
 
 		for (auto &p : paths)
-			types::Copy(p.state, p.input.GetValue());
+			bank.Add(this, &activity, p.state, &p.input.GetValue(), p.output.valuePointer, p.output.GetNumberOfDrivenPins() == 1, enable);
 
-		SetDirty();
+		return true;
+	}
 
-#else
+	void AsyncReset() override
+	{
+		for (auto &p : paths)
+			for (int lane = 0; lane < layout.lanes; ++lane)
+				types::Copy(p.state[lane], types::DefaultFrom(p.state[lane]));
 
-		DFX_SIMULATOR_DELAY_DIRTY_ON_CHANGE must be set to 0 or 1.
+		SetDirty();
+	}
 
-#endif
+	void SaveState(StateWriter &writer) const override
+	{
+		for (auto const &p : paths)
+			writer.Write(p.state, layout.lanes);
 	}
 
-	void AsyncReset() override
+	void RestoreState(StateReader &reader) override
 	{
 		for (auto &p : paths)
-			types::Copy(p.state, types::DefaultFrom(p.state));
+			reader.Read(p.state, layout.lanes);
 
 		SetDirty();
 	}
@@ -149,16 +235,18 @@ public:
 	delay_block(std::string const &tag) :
 		BlockBase("delay", tag),
 		paths(),
-		allTheSameType(true)
+		allTheSameType(true),
+		layout(),
+		activity()
 	{
 	}
 
 	node<T> add_path(node<T> const &input)
 	{
-		auto initState = types::DefaultFrom(input.GetDriver()->value);
+		auto initState = types::DefaultFrom(input.GetDriver()->GetValue());
 
 		if (!paths.empty())
-			allTheSameType = allTheSameType && (types::GetDescription(initState) == types::GetDescription(paths.back().state));
+			allTheSameType = allTheSameType && (types::GetDescription(initState) == types::GetDescription(paths.back().state[0]));
 
 		paths.emplace_back(this, input, initState);
 
@@ -172,10 +260,14 @@ protected:
 
 	InputPin<bool> enableInput;
 
-	void Step() override
+	bool IsEnabled(int lane) const override
+	{
+		return enableInput.GetValue(this->layout, lane);
+	}
+
+	InputPin<bool> const *GetEnableInput() const override
 	{
-		if (enableInput.GetValue())
-			delay_block<T>::Step();
+		return &enableInput;
 	}
 
 	std::string GetInputPinName(int index) const override
@@ -222,14 +222,9 @@ private:
 
 	std::list<path> paths;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		for (auto &path : paths)
-			blocks.insert(path.input.GetDrivingBlock());
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -237,22 +232,47 @@ private:
 		return true;
 	}
 
+	bool IsEquivalent(BlockBase const &) const override
+	{
+		return true;
+	}
+
+	static void Cast(dynfix &output, sourceT const &input, int outputFraction)
+	{
+		// TODO: This is generic, but slower than necessary for non-dynfix source type.
+
+		dynfix source(input);
+		int align = outputFraction - source.GetFraction();
+
+		if (align >= 0)
+			source.CopyShiftLeft(output, align);
+		else
+			source.CopyShiftRight(output, -align);
+
+		output.OverflowWrapAround();
+	}
+
 	void Evaluate() override
 	{
-		for (auto &p : paths) {
+		for (auto &p : paths)
+			Cast(*p.output.valuePointer, p.input.GetValue(), outputTemplate.GetFraction());
+	}
 
-			// TODO: This is generic, but slower than necessary for non-dynfix source type.
+	static void Execute(Instruction const &instruction)
+	{
+		dynfix *output = static_cast<dynfix *>(instruction.output);
+		sourceT const *input = static_cast<sourceT const *>(instruction.inputs[0]);
 
-			dynfix source(p.input.GetValue());
-			int align = outputTemplate.GetFraction() - source.GetFraction();
+		for (int lane = 0; lane < instruction.layout.lanes; ++lane)
+			Cast(output[lane], input[lane], instruction.parameters[0]);
+	}
 
-			if (align >= 0)
-				source.CopyShiftLeft(p.output.value, align);
-			else
-				source.CopyShiftRight(p.output.value, -align);
+	bool Lower(ProgramBuilder &builder) override
+	{
+		for (auto &p : paths)
+			builder.Emit(&Execute, p.output.valuePointer, { &p.input.GetValue() }, { outputTemplate.GetFraction() });
 
-			p.output.value.OverflowWrapAround();
-		}
+		return true;
 	}
 
 	std::string GetOutputPinDescription(int index, int &groupIndex, int &busSize, int &busIndex) const override
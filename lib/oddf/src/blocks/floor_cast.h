@@ -81,12 +81,12 @@ template<typename toT, typename fromT> node<typename types::TypeTraits<toT>::int
 
 template<typename toT, typename fromT> node<toT> inline FloorCast(node<toT> const &templateNode, node<fromT> const &node, CastMode castMode = CastMode::WrapAround)
 {
-	return FloorCast<toT, fromT>(templateNode.GetDriver()->value, bus<fromT>(node), castMode).first();
+	return FloorCast<toT, fromT>(*templateNode.GetDriver()->valuePointer, bus<fromT>(node), castMode).first();
 }
 
 template<typename toT, typename fromT> bus<toT> inline FloorCast(node<toT> const &templateNode, bus_access<fromT> const &bus, CastMode castMode = CastMode::WrapAround)
 {
-	return FloorCast<toT, fromT>(templateNode.GetDriver()->value, bus, castMode);
+	return FloorCast<toT, fromT>(*templateNode.GetDriver()->valuePointer, bus, castMode);
 }
 
 template<typename toT, typename fromT> node<typename types::TypeTraits<toT>::internalType> inline FloorCast(node<fromT> const &node, CastMode castMode = CastMode::WrapAround)
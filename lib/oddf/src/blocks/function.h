@@ -45,12 +45,9 @@ private:
 	std::list<OutputPin<outT>> outputs;
 	std::list<InputPin<inT>> inputs;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-		for (auto &pin : inputs)
-			blocks.insert(pin.GetDrivingBlock());
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -65,7 +62,7 @@ private:
 		auto inputFirst = inputs.begin();
 
 		while (outputFirst != outputLast)
-			(outputFirst++)->value = function((inputFirst++)->GetValue());
+			*(outputFirst++)->valuePointer = function((inputFirst++)->GetValue());
 	}
 
 public:
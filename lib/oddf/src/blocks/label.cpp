@@ -41,9 +41,9 @@ private:
 	std::string label;
 	std::list<InputPin<T>> inputs;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t();
+		return false;
 	}
 
 	bool CanEvaluate() const override
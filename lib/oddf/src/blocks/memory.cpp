@@ -63,7 +63,7 @@ private:
 	{
 		auto registerIt = outputRegister.cbegin();
 		for (auto &output : rdDataOutput)
-			types::Copy<T>(output.value, *(registerIt++));
+			types::Copy<T>(*output.valuePointer, *(registerIt++));
 
 			/*int size = (int)content.size();
 		int rdaddress = rdAddressInput.GetValue().data[0]; // lazy conversion from ufix to int
@@ -73,7 +73,7 @@ private:
 
 		int flatAddress = rdaddress * width;
 		for (auto &output : rdDataOutput)
-			types::Copy<T>(output.value, content[flatAddress++]);*/
+			types::Copy<T>(*output.valuePointer, content[flatAddress++]);*/
 	}
 
 	void Step() override
@@ -130,14 +130,36 @@ private:
 		// 	content[i] = defaultValue;
 	}
 
+	void SaveState(StateWriter &writer) const override
+	{
+		writer.Write(content);
+		writer.Write(outputRegister);
+	}
+
+	void RestoreState(StateReader &reader) override
+	{
+		reader.Read(content);
+		reader.Read(outputRegister);
+
+		if ((int)content.size() != depth * width || (int)outputRegister.size() != width)
+			StateReader::Mismatch(("size of memory '" + GetFullName() + "'").c_str());
+
+		SetDirty();
+	}
+
 	IStep *GetStep() override
 	{
 		return this;
 	}
 
-	source_blocks_t GetSourceBlocks() const override
+	InputPin<bool> const *GetEnableInput() const override
+	{
+		return &enableInput;
+	}
+
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return {};
+		return false;
 	}
 
 	std::string GetInputPinName(int index) const override
@@ -184,10 +206,10 @@ public:
 		wrDataEnable(this, wrenable),
 		wrDataInput(),
 		rdDataOutput(),
-		defaultValue(types::DefaultFrom(wrdatain.first().GetDriver()->value))
+		defaultValue(types::DefaultFrom(*wrdatain.first().GetDriver()->valuePointer))
 	{
-		auto readAddressTypeDesc = types::GetDescription(rdaddress.GetDriver()->value);
-		auto writeAddressTypeDesc = types::GetDescription(wraddress.GetDriver()->value);
+		auto readAddressTypeDesc = types::GetDescription(*rdaddress.GetDriver()->valuePointer);
+		auto writeAddressTypeDesc = types::GetDescription(*wraddress.GetDriver()->valuePointer);
 
 		if (depth <= 0)
 			throw design_error(GetFullName() + ": 'depth' must be positive.");
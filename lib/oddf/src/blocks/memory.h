@@ -52,7 +52,7 @@ DECLARE_MEMORY_FUNCTION(dynfix)
 
 template<typename T> bus<typename types::TypeTraits<T>::internalType> Memory(int size, node<dynfix> const &readAddress, node<bool> const &writeEnable, node<dynfix> const &writeAddress, bus_access<typename types::TypeTraits<T>::internalType> const &writeData, IMemoryBackdoor<typename types::TypeTraits<T>::internalType> *&backDoor)
 {
-	types::TypeDescription writeDataTypeDesc = types::GetDescription(writeData.first().GetDriver()->value);
+	types::TypeDescription writeDataTypeDesc = types::GetDescription(*writeData.first().GetDriver()->valuePointer);
 	types::TypeDescription specifiedTypeDesc = types::GetDescription(T());
 
 	if (writeDataTypeDesc != specifiedTypeDesc)
@@ -63,7 +63,7 @@ template<typename T> bus<typename types::TypeTraits<T>::internalType> Memory(int
 
 template<typename T> bus<typename types::TypeTraits<T>::internalType> Memory(int size, node<dynfix> const &readAddress, node<bool> const &writeEnable, node<dynfix> const &writeAddress, bus_access<typename types::TypeTraits<T>::internalType> const &writeData)
 {
-	types::TypeDescription writeDataTypeDesc = types::GetDescription(writeData.first().GetDriver()->value);
+	types::TypeDescription writeDataTypeDesc = types::GetDescription(*writeData.first().GetDriver()->valuePointer);
 	types::TypeDescription specifiedTypeDesc = types::GetDescription(T());
 
 	if (writeDataTypeDesc != specifiedTypeDesc)
@@ -39,12 +39,9 @@ private:
 	std::list<InputPin<double>> inputs;
 	std::list<OutputPin<double>> outputs;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-		for (auto &pin : inputs)
-			blocks.insert(pin.GetDrivingBlock());
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -61,7 +58,7 @@ private:
 		while (outputFirst != outputLast) {
 
 			double value = (inputFirst++)->GetValue();
-			(outputFirst++)->value = value - divisor * std::floor((value - offset) / divisor);
+			*(outputFirst++)->valuePointer = value - divisor * std::floor((value - offset) / divisor);
 		}
 	}
 
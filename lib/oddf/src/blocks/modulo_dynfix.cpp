@@ -50,10 +50,10 @@ bus<dynfix> Modulo(bus_access<dynfix> const &operand, dynfix divisor, dynfix off
 		offset.data[0] == -1 &&
 		divisor.GetFraction() + 1 == offset.GetFraction()) {
 
-		int fraction = operand[0].GetDriver()->value.GetFraction();
+		int fraction = operand[0].GetDriver()->valuePointer->GetFraction();
 
 		for (int i = 1; i < operand.width(); ++i)
-			if (operand[1].GetDriver()->value.GetFraction() != fraction)
+			if (operand[1].GetDriver()->valuePointer->GetFraction() != fraction)
 				throw design_error("dfx::blocks::Modulo: fractional part of all elements of the bus must be the same.");
 
 		dynfix targetType(true, fraction - divisor.GetFraction(), fraction);
@@ -69,10 +69,10 @@ bus<dynfix> Modulo(bus_access<dynfix> const &operand, dynfix divisor, dynfix off
 		offset.IsSigned() == false &&
 		offset.data[0] == 0) {
 
-		int fraction = operand[0].GetDriver()->value.GetFraction();
+		int fraction = operand[0].GetDriver()->valuePointer->GetFraction();
 
 		for (int i = 1; i < operand.width(); ++i)
-			if (operand[1].GetDriver()->value.GetFraction() != fraction)
+			if (operand[1].GetDriver()->valuePointer->GetFraction() != fraction)
 				throw design_error("dfx::blocks::Modulo: fractional part of all elements of the bus must be the same.");
 
 		dynfix targetType(false, fraction - divisor.GetFraction(), fraction);
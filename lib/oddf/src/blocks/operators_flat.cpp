@@ -56,12 +56,9 @@ protected:
 	{
 	}
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-		for (auto &pin : inputs)
-			blocks.insert(pin.GetDrivingBlock());
-		return blocks;
+		return true;
 	}
 
 	void GetProperties(dfx::generator::Properties &properties) const override
@@ -69,6 +66,11 @@ protected:
 		properties.SetInt("NumberOfOperands", NumberOfOperands);
 	}
 
+	bool IsEquivalent(BlockBase const &other) const override
+	{
+		return HasEqualProperties(other);
+	}
+
 	std::string GetOutputPinDescription(int index, int &groupIndex, int &busSize, int &busIndex) const override
 	{
 		/*
@@ -118,6 +120,14 @@ public:
 namespace backend {
 namespace blocks {
 
+// Kernel of a flat operator block for 64 packed bool lanes at once, or
+// nullptr. Specialised for the boolean operators below.
+template<typename blockT>
+struct flat_operator_words {
+
+	static constexpr Kernel kernel = nullptr;
+};
+
 #define MAKE_FLAT_OPERATOR_BLOCK(_name_, _op_, _default_) \
 	template<typename T> class _name_##_block : public abstract_flat_operator_block<T> { \
 	 \
@@ -153,9 +163,62 @@ namespace blocks {
 					result = result _op_ value; \
 				} \
 	 \
-				(outputIt++)->value = result; \
+				*(outputIt++)->valuePointer = result; \
+			} \
+		} \
+	 \
+		static void Execute(Instruction const &instruction) \
+		{ \
+			T *output = static_cast<T *>(instruction.output); \
+	 \
+			if (instruction.layout.lanes == 1) { \
+	 \
+				T result = T(_default_); \
+	 \
+				for (int i = 0; i < instruction.count; ++i) { \
+	 \
+					T value = *static_cast<T const *>(instruction.inputs[i]); \
+					result = result _op_ value; \
+				} \
+	 \
+				*output = result; \
+				return; \
+			} \
+	 \
+			/* Operand-major order keeps the inner loop over lanes vectorisable. */ \
+			int lanes = instruction.layout.lanes; \
+	 \
+			for (int lane = 0; lane < lanes; ++lane) \
+				output[lane] = T(_default_); \
+	 \
+			for (int i = 0; i < instruction.count; ++i) { \
+	 \
+				T const *values = static_cast<T const *>(instruction.inputs[i]); \
+	 \
+				for (int lane = 0; lane < lanes; ++lane) \
+					output[lane] = output[lane] _op_ values[lane]; \
 			} \
 		} \
+	 \
+		bool Lower(ProgramBuilder &builder) override \
+		{ \
+			Kernel kernel = &Execute; \
+			if (builder.GetLayout().packedBooleans && flat_operator_words<_name_##_block>::kernel != nullptr) \
+				kernel = flat_operator_words<_name_##_block>::kernel; \
+	 \
+			auto inputIt = inputs.begin(); \
+	 \
+			for (auto &output : outputs) { \
+	 \
+				std::vector<void const *> operands; \
+				for (unsigned i = 0; i < NumberOfOperands; ++i) \
+					operands.push_back(&(inputIt++)->GetValue()); \
+	 \
+				builder.Emit(kernel, output.valuePointer, operands); \
+			} \
+	 \
+			return true; \
+		} \
 	};
 
 MAKE_FLAT_OPERATOR_BLOCK(or, ||, false)
@@ -165,6 +228,34 @@ MAKE_FLAT_OPERATOR_BLOCK(xor, !=, false)
 MAKE_FLAT_OPERATOR_BLOCK(plus, +, 0)
 MAKE_FLAT_OPERATOR_BLOCK(times, *, 1)
 
+// '_wordop_' applies the operator to 64 packed bool lanes at once.
+#define MAKE_FLAT_OPERATOR_WORDS(_name_, _wordop_, _default_) \
+	template<> \
+	struct flat_operator_words<_name_##_block<bool>> { \
+	 \
+		static void Execute(Instruction const &instruction) \
+		{ \
+			bool *output = static_cast<bool *>(instruction.output); \
+			int words = instruction.layout.GetNumberOfWords(); \
+	 \
+			for (int word = 0; word < words; ++word) { \
+	 \
+				std::uint64_t result = bool(_default_) ? ~std::uint64_t(0) : std::uint64_t(0); \
+	 \
+				for (int i = 0; i < instruction.count; ++i) \
+					result = result _wordop_ LoadWord(static_cast<bool const *>(instruction.inputs[i]), word); \
+	 \
+				StoreWord(output, word, result); \
+			} \
+		} \
+	 \
+		static constexpr Kernel kernel = &Execute; \
+	};
+
+MAKE_FLAT_OPERATOR_WORDS(or, |, false)
+MAKE_FLAT_OPERATOR_WORDS(and, &, true)
+MAKE_FLAT_OPERATOR_WORDS(xor, ^, false)
+
 template<typename blockT, typename T>
 static inline node<T> FlatOperator(node<T> const &op1, node<T> const &op2)
 {
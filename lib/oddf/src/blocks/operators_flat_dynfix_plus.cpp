@@ -70,15 +70,9 @@ private:
 
 	std::list<Sum> sums;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-		for (auto &sum : sums) {
-
-			for (auto &summand : sum.summands)
-				blocks.insert(summand.input.GetDrivingBlock());
-		}
-		return blocks;
+		return true;
 	}
 
 	void GetProperties(dfx::generator::Properties &properties) const override
@@ -97,17 +91,53 @@ private:
 
 			auto summandIt = sum.summands.begin();
 			dynfix value = (*summandIt).input.GetValue();
-			value.CopyShiftLeft(sum.output.value, (*summandIt).align);
+			value.CopyShiftLeft(*sum.output.valuePointer, (*summandIt).align);
 			++summandIt;
 
 			for (; summandIt != sum.summands.end(); ++summandIt) {
 
 				dynfix value = (*summandIt).input.GetValue();
-				value.AccumulateShiftLeft(sum.output.value, (*summandIt).align);
+				value.AccumulateShiftLeft(*sum.output.valuePointer, (*summandIt).align);
+			}
+		}
+	}
+
+	static void Execute(Instruction const &instruction)
+	{
+		for (int lane = 0; lane < instruction.layout.lanes; ++lane) {
+
+			dynfix &output = static_cast<dynfix *>(instruction.output)[lane];
+
+			dynfix value = static_cast<dynfix const *>(instruction.inputs[0])[lane];
+			value.CopyShiftLeft(output, instruction.parameters[0]);
+
+			for (int i = 1; i < instruction.count; ++i) {
+
+				dynfix value = static_cast<dynfix const *>(instruction.inputs[i])[lane];
+				value.AccumulateShiftLeft(output, instruction.parameters[i]);
 			}
 		}
 	}
 
+	bool Lower(ProgramBuilder &builder) override
+	{
+		for (auto &sum : sums) {
+
+			std::vector<void const *> operands;
+			std::vector<int> aligns;
+
+			for (auto &summand : sum.summands) {
+
+				operands.push_back(&summand.input.GetValue());
+				aligns.push_back(summand.align);
+			}
+
+			builder.Emit(&Execute, sum.output.valuePointer, operands, aligns);
+		}
+
+		return true;
+	}
+
 public:
 
 	plus_operator_block_dynfix() :
@@ -123,7 +153,7 @@ public:
 
 		std::vector<dynfix> inputTypes;
 		inputTypes.reserve(numberOfSummands);
-		std::transform(first, last, std::back_inserter(inputTypes), [](node<dynfix> const *input) { return input->GetDriver()->value; });
+		std::transform(first, last, std::back_inserter(inputTypes), [](node<dynfix> const *input) { return *input->GetDriver()->valuePointer; });
 
 		dynfix commonTemplate = dynfix::CommonRepresentation(inputTypes.cbegin(), inputTypes.cend());
 
@@ -139,7 +169,7 @@ public:
 		for (auto input = first; input != last; ++input) {
 
 			node<dynfix> const &summandNode = **input;
-			sums.back().summands.emplace_back(this, fraction - summandNode.GetDriver()->value.GetFraction(), summandNode);
+			sums.back().summands.emplace_back(this, fraction - summandNode.GetDriver()->valuePointer->GetFraction(), summandNode);
 		}
 
 		return sums.back().output.GetNode();
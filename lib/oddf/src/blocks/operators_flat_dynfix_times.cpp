@@ -66,15 +66,9 @@ private:
 
 	std::list<Product> products;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-		for (auto &product : products) {
-
-			for (auto &factor : product.factors)
-				blocks.insert(factor.input.GetDrivingBlock());
-		}
-		return blocks;
+		return true;
 	}
 
 	void GetProperties(dfx::generator::Properties &properties) const override
@@ -87,23 +81,46 @@ private:
 		return true;
 	}
 
+	static void Multiply(dynfix &output, dynfix factor1, dynfix factor2)
+	{
+		factor1.CopyMultiplyUnsigned(output, (std::uint32_t)factor2.data[0]);
+		for (int j = 1; j < dynfix::MAX_FIELDS - 1; ++j)
+			factor1.AccumulateMultiplyUnsigned(output, factor2.data[j], j);
+
+		if (factor2.IsSigned())
+			factor1.AccumulateMultiplySigned(output, factor2.data[dynfix::MAX_FIELDS - 1], dynfix::MAX_FIELDS - 1);
+		else
+			factor1.AccumulateMultiplyUnsigned(output, factor2.data[dynfix::MAX_FIELDS - 1], dynfix::MAX_FIELDS - 1);
+	}
+
 	void Evaluate() override
 	{
 		for (auto &product : products) {
 
 			auto factorIt = product.factors.begin();
-			dynfix factor1 = factorIt->input.GetValue();
-			dynfix factor2 = std::next(factorIt)->input.GetValue();
+			Multiply(*product.output.valuePointer, factorIt->input.GetValue(), std::next(factorIt)->input.GetValue());
+		}
+	}
 
-			factor1.CopyMultiplyUnsigned(product.output.value, (std::uint32_t)factor2.data[0]);
-			for (int j = 1; j < dynfix::MAX_FIELDS - 1; ++j)
-				factor1.AccumulateMultiplyUnsigned(product.output.value, factor2.data[j], j);
+	static void Execute(Instruction const &instruction)
+	{
+		dynfix *output = static_cast<dynfix *>(instruction.output);
+		dynfix const *left = static_cast<dynfix const *>(instruction.inputs[0]);
+		dynfix const *right = static_cast<dynfix const *>(instruction.inputs[1]);
+
+		for (int lane = 0; lane < instruction.layout.lanes; ++lane)
+			Multiply(output[lane], left[lane], right[lane]);
+	}
 
-			if (factor2.IsSigned())
-				factor1.AccumulateMultiplySigned(product.output.value, factor2.data[dynfix::MAX_FIELDS - 1], dynfix::MAX_FIELDS - 1);
-			else
-				factor1.AccumulateMultiplyUnsigned(product.output.value, factor2.data[dynfix::MAX_FIELDS - 1], dynfix::MAX_FIELDS - 1);
+	bool Lower(ProgramBuilder &builder) override
+	{
+		for (auto &product : products) {
+
+			auto factorIt = product.factors.begin();
+			builder.Emit(&Execute, product.output.valuePointer, { &factorIt->input.GetValue(), &std::next(factorIt)->input.GetValue() });
 		}
+
+		return true;
 	}
 
 public:
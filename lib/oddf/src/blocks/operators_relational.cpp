@@ -56,17 +56,9 @@ protected:
 
 	std::list<Path> paths;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		for (auto &path : paths) {
-
-			blocks.insert(path.leftInput.GetDrivingBlock());
-			blocks.insert(path.rightInput.GetDrivingBlock());
-		}
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -74,6 +66,11 @@ protected:
 		return true;
 	}
 
+	bool IsEquivalent(BlockBase const &) const override
+	{
+		return true;
+	}
+
 	std::string GetInputPinName(int index) const override
 	{
 		if (index >= 0 && index < (int)GetInputPins().size())
@@ -130,7 +127,25 @@ public:
 		void Evaluate() override \
 		{ \
 			for (auto &p : paths) \
-				p.output.value = p.leftInput.GetValue() _op_ p.rightInput.GetValue(); \
+				*p.output.valuePointer = p.leftInput.GetValue() _op_ p.rightInput.GetValue(); \
+		} \
+	 \
+		static void Execute(Instruction const &instruction) \
+		{ \
+			bool *output = static_cast<bool *>(instruction.output); \
+			T const *left = static_cast<T const *>(instruction.inputs[0]); \
+			T const *right = static_cast<T const *>(instruction.inputs[1]); \
+			auto const &layout = instruction.layout; \
+	 \
+			layout.SetBooleans(output, [&](int lane) { return layout.Get(left, lane) _op_ layout.Get(right, lane); }); \
+		} \
+	 \
+		bool Lower(ProgramBuilder &builder) override \
+		{ \
+			for (auto &p : paths) \
+				builder.Emit(&Execute, p.output.valuePointer, { &p.leftInput.GetValue(), &p.rightInput.GetValue() }); \
+	 \
+			return true; \
 		} \
 	};
 
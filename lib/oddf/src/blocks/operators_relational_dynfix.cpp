@@ -65,17 +65,9 @@ protected:
 
 	std::list<Path> paths;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		for (auto &path : paths) {
-
-			blocks.insert(path.leftInput.GetDrivingBlock());
-			blocks.insert(path.rightInput.GetDrivingBlock());
-		}
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -92,35 +84,58 @@ protected:
 		return "<ERROR>";
 	}
 
-	void Evaluate() override
+	static bool Compare(dynfix const &left, int leftShift, dynfix const &right, int rightShift, bool signedCompare)
 	{
-		for (auto &p : paths) {
+		int result;
 
-			int result;
+		if (leftShift > 0) {
 
-			if (p.leftShift > 0) {
+			dynfix temp;
+			left.CopyShiftLeft(temp, leftShift);
 
-				dynfix temp;
-				p.leftInput.GetValue().CopyShiftLeft(temp, p.leftShift);
+			if (signedCompare)
+				result = -right.CompareSigned(temp);
+			else
+				result = -right.CompareUnsigned(temp);
+		}
+		else {
 
-				if (p.signedCompare)
-					result = -p.rightInput.GetValue().CompareSigned(temp);
-				else
-					result = -p.rightInput.GetValue().CompareUnsigned(temp);
-			}
-			else {
+			dynfix temp;
+			right.CopyShiftLeft(temp, rightShift);
 
-				dynfix temp;
-				p.rightInput.GetValue().CopyShiftLeft(temp, p.rightShift);
+			if (signedCompare)
+				result = left.CompareSigned(temp);
+			else
+				result = left.CompareUnsigned(temp);
+		}
 
-				if (p.signedCompare)
-					result = p.leftInput.GetValue().CompareSigned(temp);
-				else
-					result = p.leftInput.GetValue().CompareUnsigned(temp);
-			}
+		return (result == true1) || (result == true2);
+	}
 
-			p.output.value = (result == true1) || (result == true2);
-		}
+	void Evaluate() override
+	{
+		for (auto &p : paths)
+			*p.output.valuePointer = Compare(p.leftInput.GetValue(), p.leftShift, p.rightInput.GetValue(), p.rightShift, p.signedCompare);
+	}
+
+	static void Execute(Instruction const &instruction)
+	{
+		bool *output = static_cast<bool *>(instruction.output);
+		dynfix const *left = static_cast<dynfix const *>(instruction.inputs[0]);
+		dynfix const *right = static_cast<dynfix const *>(instruction.inputs[1]);
+
+		instruction.layout.SetBooleans(output, [&](int lane) {
+
+			return Compare(left[lane], instruction.parameters[0], right[lane], instruction.parameters[1], instruction.parameters[2] != 0);
+		});
+	}
+
+	bool Lower(ProgramBuilder &builder) override
+	{
+		for (auto &p : paths)
+			builder.Emit(&Execute, p.output.valuePointer, { &p.leftInput.GetValue(), &p.rightInput.GetValue() }, { p.leftShift, p.rightShift, p.signedCompare ? 1 : 0 });
+
+		return true;
 	}
 
 public:
@@ -133,8 +148,8 @@ public:
 
 	node<bool> add_path(node<dynfix> const &leftOperand, node<dynfix> const &rightOperand)
 	{
-		dynfix leftTemplate = types::DefaultFrom(leftOperand.GetDriver()->value);
-		dynfix rightTemplate = types::DefaultFrom(rightOperand.GetDriver()->value);
+		dynfix leftTemplate = types::DefaultFrom(*leftOperand.GetDriver()->valuePointer);
+		dynfix rightTemplate = types::DefaultFrom(*rightOperand.GetDriver()->valuePointer);
 
 		bool leftSigned = leftTemplate.IsSigned();
 		int leftWordWidth = leftTemplate.GetWordWidth();
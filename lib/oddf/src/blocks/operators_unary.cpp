@@ -54,14 +54,9 @@ protected:
 
 	std::list<Path> paths;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		for (auto &path : paths)
-			blocks.insert(path.input.GetDrivingBlock());
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -69,6 +64,11 @@ protected:
 		return true;
 	}
 
+	bool IsEquivalent(BlockBase const &) const override
+	{
+		return true;
+	}
+
 	abstract_unary_operator_block(char const *name) :
 		BlockBase(name),
 		paths()
@@ -120,7 +120,24 @@ private:
 	void Evaluate() override
 	{
 		for (auto &p : paths)
-			p.output.value = -p.input.GetValue();
+			*p.output.valuePointer = -p.input.GetValue();
+	}
+
+	static void Execute(Instruction const &instruction)
+	{
+		T *output = static_cast<T *>(instruction.output);
+		T const *input = static_cast<T const *>(instruction.inputs[0]);
+
+		for (int lane = 0; lane < instruction.layout.lanes; ++lane)
+			output[lane] = -input[lane];
+	}
+
+	bool Lower(ProgramBuilder &builder) override
+	{
+		for (auto &p : paths)
+			builder.Emit(&Execute, p.output.valuePointer, { &p.input.GetValue() });
+
+		return true;
 	}
 };
 
@@ -165,7 +182,36 @@ private:
 	void Evaluate() override
 	{
 		for (auto &p : paths)
-			p.output.value = !p.input.GetValue();
+			*p.output.valuePointer = !p.input.GetValue();
+	}
+
+	static void Execute(Instruction const &instruction)
+	{
+		bool *output = static_cast<bool *>(instruction.output);
+		bool const *input = static_cast<bool const *>(instruction.inputs[0]);
+
+		for (int lane = 0; lane < instruction.layout.lanes; ++lane)
+			output[lane] = !input[lane];
+	}
+
+	// Inverts 64 packed lanes at once.
+	static void ExecuteWords(Instruction const &instruction)
+	{
+		bool *output = static_cast<bool *>(instruction.output);
+		bool const *input = static_cast<bool const *>(instruction.inputs[0]);
+
+		for (int word = 0; word < instruction.layout.GetNumberOfWords(); ++word)
+			StoreWord(output, word, ~LoadWord(input, word));
+	}
+
+	bool Lower(ProgramBuilder &builder) override
+	{
+		Kernel kernel = builder.GetLayout().packedBooleans ? &ExecuteWords : &Execute;
+
+		for (auto &p : paths)
+			builder.Emit(kernel, p.output.valuePointer, { &p.input.GetValue() });
+
+		return true;
 	}
 };
 
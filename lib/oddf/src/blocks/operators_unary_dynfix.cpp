@@ -54,14 +54,9 @@ private:
 
 	std::list<path> paths;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		for (auto &path : paths)
-			blocks.insert(path.input.GetDrivingBlock());
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -72,7 +67,7 @@ private:
 	void Evaluate() override
 	{
 		for (auto &p : paths)
-			p.input.GetValue().CopyNegate(p.output.value);
+			p.input.GetValue().CopyNegate(*p.output.valuePointer);
 	}
 
 public:
@@ -85,7 +80,7 @@ public:
 
 	node<dynfix> add_node(node<dynfix> const &operand)
 	{
-		dynfix operandTemplate = types::DefaultFrom(operand.GetDriver()->value);
+		dynfix operandTemplate = types::DefaultFrom(*operand.GetDriver()->valuePointer);
 		dynfix outputTemplate(true, operandTemplate.GetWordWidth() + 1, operandTemplate.GetFraction());
 
 		paths.emplace_back(this, operand, outputTemplate);
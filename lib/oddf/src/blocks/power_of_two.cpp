@@ -72,7 +72,7 @@ bus<std::int64_t> PowerOfTwo(bus_access<std::int64_t> const &exponent)
 
 node<dynfix> PowerOfTwo(node<dynfix> const &exponent)
 {
-	auto expTypeDesc = types::GetDescription(exponent.GetDriver()->value);
+	auto expTypeDesc = types::GetDescription(*exponent.GetDriver()->valuePointer);
 
 	if (expTypeDesc.GetFraction() > 0)
 		throw design_error("dfx::blocks::PowerOfTwo: 'exponent' must be an integer, i.e., its fractional part must be negative or zero. Type of 'exponent' is '" + expTypeDesc.ToString() + "'.");
@@ -115,8 +115,8 @@ bus<dynfix> TimesPowerOfTwo(bus_access<dynfix> const &values, node<dynfix> const
 
 node<dynfix> TimesPowerOfTwo(node<dynfix> const &value, node<dynfix> const &exponent, int exponentMin, int exponentMax)
 {
-	auto valueTypeDesc = types::GetDescription(value.GetDriver()->value);
-	auto expTypeDesc = types::GetDescription(exponent.GetDriver()->value);
+	auto valueTypeDesc = types::GetDescription(*value.GetDriver()->valuePointer);
+	auto expTypeDesc = types::GetDescription(*exponent.GetDriver()->valuePointer);
 
 	if (expTypeDesc.GetFraction() > 0)
 		throw design_error("dfx::blocks::TimesPowerOfTwo: 'exponent' must be an integer, i.e., its fractional part must be negative or zero. Type of 'exponent' is '" + expTypeDesc.ToString() + "'.");
@@ -37,10 +37,11 @@ private:
 
 	InputPin<T> input;
 	T variable;
+	LaneLayout layout;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t({ input.GetDrivingBlock() });
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -48,9 +49,21 @@ private:
 		return true;
 	}
 
+	bool IsObservable() const override
+	{
+		return true;
+	}
+
 	void Evaluate() override
 	{
-		variable = input.GetValue();
+		variable = input.GetValue(layout, 0);
+	}
+
+	// Probes observe the first lane.
+	bool SetLanes(LaneLayout const &theLayout) override
+	{
+		layout = theLayout;
+		return true;
 	}
 
 public:
@@ -58,7 +71,8 @@ public:
 	probe_block(node<T> const &theNode) :
 		BlockBase("probe"),
 		input(this, theNode),
-		variable()
+		variable(),
+		layout()
 	{
 	}
 
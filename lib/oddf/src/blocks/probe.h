@@ -21,7 +21,8 @@
 /*
 
 	Probe() allows a normal C++ variable to probe the value of the
-	provided node during simulation.
+	provided node during simulation. If the simulator runs several lanes,
+	the variable holds the value of the first lane.
 
 */
 
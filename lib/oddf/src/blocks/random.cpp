@@ -45,9 +45,9 @@ private:
 
 	std::vector<int> values;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &pin) const override
 	{
-		return source_blocks_t({ maxInput.GetDrivingBlock() });
+		return &pin == &maxInput;
 	}
 
 	void generate_next()
@@ -75,7 +75,7 @@ private:
 		auto outputIt = outputs.begin();
 
 		for (size_t i = 0; i < width; ++i)
-			(outputIt++)->value = values[i];
+			*(outputIt++)->valuePointer = values[i];
 	}
 
 	void Step() override
@@ -91,6 +91,30 @@ private:
 	{
 	}
 
+	// The engine is shared by all random blocks. Each of them saves it, so
+	// that restoring any one recovers the sequence.
+	void SaveState(StateWriter &writer) const override
+	{
+		std::ostringstream engine;
+		engine << randomEngine;
+
+		writer.Write(initialised);
+		writer.Write(values);
+		writer.Write(engine.str());
+	}
+
+	void RestoreState(StateReader &reader) override
+	{
+		std::string engine;
+
+		reader.Read(initialised);
+		reader.Read(values);
+		reader.Read(engine);
+
+		std::istringstream(engine) >> randomEngine;
+		SetDirty();
+	}
+
 	IStep *GetStep()
 	{
 		return this;
@@ -167,14 +167,9 @@ private:
 
 	std::list<path> paths;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		for (auto &path : paths)
-			blocks.insert(path.input.GetDrivingBlock());
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -185,7 +180,7 @@ private:
 	void Evaluate() override
 	{
 		for (auto &path : paths)
-			ReinterpretCastImpl(path.output.value, path.input.GetValue());
+			ReinterpretCastImpl(*path.output.valuePointer, path.input.GetValue());
 	}
 
 	std::string GetOutputPinDescription(int index, int &groupIndex, int &busSize, int &busIndex) const override
@@ -351,7 +346,7 @@ template<> bus<dynfix> ReinterpretCast(dynfix const &outputTemplate, bus_access<
 
 	// Check if one of the input has a type different from the target type. Then we instantiate the converter block. This is the typical scenario.
 	for (int i = 0; i < width; ++i)
-		if (types::GetDescription(input[i].GetDriver()->value) != targetTypeDesc)
+		if (types::GetDescription(*input[i].GetDriver()->valuePointer) != targetTypeDesc)
 			return Design::GetCurrent().NewBlock<backend::blocks::reinterpret_cast_block<dynfix, dynfix>>(outputTemplate).add_bus(input);
 
 	// In case all inputs already have the target type (not the intended use case, but could happen), we just pass them through.
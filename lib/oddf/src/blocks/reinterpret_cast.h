@@ -73,7 +73,7 @@ template<typename toT, typename fromT> node<typename types::TypeTraits<toT>::int
 
 template<typename toT, typename fromT> node<toT> inline ReinterpretCast(node<toT> const &templateNode, node<fromT> const &node)
 {
-	return ReinterpretCast<toT, fromT>(templateNode.GetDriver()->value, bus<fromT>(node)).first();
+	return ReinterpretCast<toT, fromT>(*templateNode.GetDriver()->valuePointer, bus<fromT>(node)).first();
 }
 
 template<typename toT, typename fromT> node<typename types::TypeTraits<toT>::internalType> inline ReinterpretCast(node<fromT> const &node)
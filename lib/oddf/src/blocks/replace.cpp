@@ -40,19 +40,9 @@ private:
 	std::list<InputPin<T>> newInputs;
 	std::list<OutputPin<T>> outputs;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		blocks.insert(indexInput.GetDrivingBlock());
-
-		for (auto &pin : originalInputs)
-			blocks.insert(pin.GetDrivingBlock());
-
-		for (auto &pin : newInputs)
-			blocks.insert(pin.GetDrivingBlock());
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -82,7 +72,7 @@ private:
 			if (i == index)
 				startIt = outputIt;
 
-			outputIt->value = originalIt->GetValue();
+			*outputIt->valuePointer = originalIt->GetValue();
 
 			++outputIt;
 			++originalIt;
@@ -94,7 +84,7 @@ private:
 		// Replace values in outputs by values from newInputs starting from the given index
 		for (i = 0; i < newInputsWidth; ++i) {
 
-			startIt->value = newIt->GetValue();
+			*startIt->valuePointer = newIt->GetValue();
 
 			++startIt;
 			++newIt;
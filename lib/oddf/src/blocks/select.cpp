@@ -42,16 +42,9 @@ private:
 	std::vector<std::unique_ptr<InputPin<T>>> inputs;
 	std::list<OutputPin<T>> outputs;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		blocks.insert(indexInput.GetDrivingBlock());
-
-		for (auto &pin : inputs)
-			blocks.insert(pin->GetDrivingBlock());
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -59,6 +52,12 @@ private:
 		return true;
 	}
 
+	bool IsEquivalent(BlockBase const &other) const override
+	{
+		auto &block = static_cast<select_block const &>(other);
+		return length == block.length && inputWidth == block.inputWidth && stride == block.stride;
+	}
+
 	void Evaluate() override
 	{
 		assert(length == (int)outputs.size());
@@ -71,7 +70,7 @@ private:
 
 		for (auto &output : outputs) {
 
-			output.value = inputs[index]->GetValue();
+			*output.valuePointer = inputs[index]->GetValue();
 			++index;
 		}
 	}
@@ -113,7 +112,7 @@ public:
 		inputs(),
 		outputs()
 	{
-		auto indexTypeDesc = types::GetDescription(indexNode.GetDriver()->value);
+		auto indexTypeDesc = types::GetDescription(*indexNode.GetDriver()->valuePointer);
 
 		if (indexTypeDesc.GetFraction() > 0)
 			throw design_error(GetFullName() + ": type of 'Index' input must have fractional part less than equal to zero. Current type is '" + indexTypeDesc.ToString() + "'.");
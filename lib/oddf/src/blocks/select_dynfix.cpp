@@ -56,16 +56,9 @@ private:
 	std::vector<std::unique_ptr<Input>> inputs;
 	std::list<OutputPin<dynfix>> outputs;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-
-		blocks.insert(indexInput.GetDrivingBlock());
-
-		for (auto &input : inputs)
-			blocks.insert(input->input.GetDrivingBlock());
-
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -82,7 +75,7 @@ private:
 
 		for (auto &output : outputs) {
 
-			inputs[index]->input.GetValue().CopyShiftLeft(output.value, inputs[index]->align);
+			inputs[index]->input.GetValue().CopyShiftLeft(*output.valuePointer, inputs[index]->align);
 			++index;
 		}
 	}
@@ -123,7 +116,7 @@ public:
 		inputs(),
 		outputs()
 	{
-		auto indexTypeDesc = types::GetDescription(indexNode.GetDriver()->value);
+		auto indexTypeDesc = types::GetDescription(*indexNode.GetDriver()->valuePointer);
 
 		if (indexTypeDesc.GetFraction() > 0)
 			throw design_error(GetFullName() + ": type of 'Index' input must have fractional part less than equal to zero. Current type is '" + indexTypeDesc.ToString() + "'.");
@@ -136,7 +129,7 @@ public:
 		std::vector<dynfix> inputTypes;
 		inputTypes.reserve(inputWidth);
 		for (int i = 0; i < inputWidth; ++i)
-			inputTypes.push_back(input[i].GetDriver()->value);
+			inputTypes.push_back(*input[i].GetDriver()->valuePointer);
 
 		dynfix commonTemplate = dynfix::CommonRepresentation(inputTypes.cbegin(), inputTypes.cend());
 		int fraction = commonTemplate.GetFraction();
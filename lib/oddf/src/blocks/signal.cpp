@@ -37,10 +37,11 @@ private:
 
 	OutputPin<T> output;
 	T const *variable;
+	LaneLayout layout;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t();
+		return false;
 	}
 
 	bool CanEvaluate() const override
@@ -50,16 +51,25 @@ private:
 
 	void Evaluate() override
 	{
-		output.value = *variable;
+		for (int lane = 0; lane < layout.lanes; ++lane)
+			layout.Set(output.valuePointer, lane, variable[lane]);
+
 		SetDirty();
 	}
 
+	bool SetLanes(LaneLayout const &theLayout) override
+	{
+		layout = theLayout;
+		return true;
+	}
+
 public:
 
 	signal_block(T const *theVariable) :
 		BlockBase("signal"),
 		output(this, *theVariable),
-		variable(theVariable)
+		variable(theVariable),
+		layout()
 	{
 	}
 
@@ -21,7 +21,8 @@
 /*
 
 	Signal() allows a normal C++ variable to provide a value to a node in
-	the design.
+	the design. If the simulator runs several lanes, 'variable' must point
+	to an array with one value per lane.
 
 */
 
@@ -39,9 +39,9 @@ private:
 
 	int mNumberOfBits;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t();
+		return false;
 	}
 
 	bool CanEvaluate() const override
@@ -38,9 +38,9 @@ private:
 
 	std::list<InputPin<T>> inputs;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t();
+		return false;
 	}
 
 	bool CanEvaluate() const override
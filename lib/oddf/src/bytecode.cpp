@@ -0,0 +1,132 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Bytecode representation of the execution schedule.
+
+*/
+
+#include "global.h"
+
+namespace dfx {
+namespace backend {
+
+static void ExecuteCall(Instruction const &instruction)
+{
+	instruction.block->Evaluate();
+}
+
+Program::Program() :
+	instructions(),
+	inputPool(),
+	parameterPool(),
+	blockStarts(1, 0),
+	numberOfCalls(0),
+	nativeFunction(nullptr),
+	nativeValues(),
+	nativeContext(),
+	nativeLibrary()
+{
+}
+
+void Program::ExecuteRange(void const *program, int firstBlock, int lastBlock)
+{
+	auto const &self = *static_cast<Program const *>(program);
+
+	Instruction const *instruction = self.instructions.data() + self.blockStarts[firstBlock];
+	Instruction const *end = self.instructions.data() + self.blockStarts[lastBlock];
+
+	for (; instruction != end; ++instruction)
+		instruction->execute(*instruction);
+}
+
+bool Program::CallsEvaluate(int block) const
+{
+	return blockStarts[block] < blockStarts[block + 1] && instructions[blockStarts[block]].execute == &ExecuteCall;
+}
+
+void Program::SetNative(NativeFunction function, std::vector<void *> const &values, std::shared_ptr<void> const &library)
+{
+	nativeFunction = function;
+	nativeValues = values;
+	nativeLibrary = library;
+
+	nativeContext.values = nativeValues.data();
+	nativeContext.program = this;
+	nativeContext.execute = &Program::ExecuteRange;
+}
+
+ProgramBuilder::ProgramBuilder(Program &program, LaneLayout const &layout) :
+	program(program),
+	layout(layout),
+	inputOffsets(),
+	parameterOffsets()
+{
+}
+
+bool ProgramBuilder::Add(BlockBase *block)
+{
+	auto first = program.instructions.size();
+	auto firstInput = program.inputPool.size();
+	auto firstParameter = program.parameterPool.size();
+	bool lowered = block->Lower(*this);
+
+	if (!lowered) {
+
+		// Discard anything emitted before the block gave up.
+		program.instructions.resize(first);
+		inputOffsets.resize(first);
+		parameterOffsets.resize(first);
+		program.inputPool.resize(firstInput);
+		program.parameterPool.resize(firstParameter);
+
+		Emit(&ExecuteCall, nullptr, {});
+		program.instructions.back().block = block;
+		++program.numberOfCalls;
+	}
+
+	program.blockStarts.push_back((int)program.instructions.size());
+
+	return lowered;
+}
+
+void ProgramBuilder::Emit(Kernel kernel, void *output, std::vector<void const *> const &inputs, std::vector<int> const &parameters /* = std::vector<int>() */)
+{
+	inputOffsets.push_back((int)program.inputPool.size());
+	parameterOffsets.push_back((int)program.parameterPool.size());
+
+	program.inputPool.insert(program.inputPool.end(), inputs.begin(), inputs.end());
+	program.parameterPool.insert(program.parameterPool.end(), parameters.begin(), parameters.end());
+
+	program.instructions.push_back(Instruction { kernel, output, nullptr, nullptr, (int)inputs.size(), layout, nullptr });
+}
+
+void ProgramBuilder::Finish()
+{
+	for (std::size_t i = 0; i < program.instructions.size(); ++i) {
+
+		program.instructions[i].inputs = program.inputPool.data() + inputOffsets[i];
+		program.instructions[i].parameters = program.parameterPool.data() + parameterOffsets[i];
+	}
+}
+
+}
+}
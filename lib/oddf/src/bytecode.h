@@ -0,0 +1,208 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Bytecode representation of the execution schedule. Blocks that support
+	it lower their evaluation into instructions that operate directly on
+	the values of their pins. All other blocks are executed by a call to
+	Evaluate().
+
+*/
+
+#pragma once
+
+namespace dfx {
+namespace backend {
+
+class BlockBase;
+class Program;
+struct Instruction;
+
+// Function that executes a single instruction. Kernels are defined next to
+// the blocks whose Evaluate() they replace. Every input and output pointer
+// addresses the values of all lanes of a pin as described by 'layout'
+// (see Simulator::Options::lanes).
+using Kernel = void (*)(Instruction const &instruction);
+
+struct Instruction {
+
+	Kernel execute;
+	void *output;
+	void const *const *inputs;
+	int const *parameters;
+	int count;
+	LaneLayout layout;
+	BlockBase *block;
+};
+
+// Arguments of natively compiled component code (see lib/native). The
+// generated code declares a layout-compatible structure.
+struct NativeContext {
+
+	// Addresses of all values the code was generated for.
+	void *const *values;
+
+	// Executes the instructions of the given range of blocks. Used for blocks
+	// that have no native implementation.
+	Program const *program;
+	void (*execute)(void const *program, int firstBlock, int lastBlock);
+};
+
+using NativeFunction = void (*)(NativeContext const *context);
+
+//
+// Program: the instructions of one component in evaluation order.
+//
+
+class Program {
+
+private:
+
+	std::vector<Instruction> instructions;
+	std::vector<void const *> inputPool;
+	std::vector<int> parameterPool;
+
+	// Index of the first instruction of every block in the schedule plus the
+	// total number of instructions.
+	std::vector<int> blockStarts;
+
+	int numberOfCalls;
+
+	// Natively compiled replacement for the whole program. 'nativeLibrary'
+	// keeps the shared library loaded as long as the code is in use.
+	NativeFunction nativeFunction;
+	std::vector<void *> nativeValues;
+	NativeContext nativeContext;
+	std::shared_ptr<void> nativeLibrary;
+
+	static void ExecuteRange(void const *program, int firstBlock, int lastBlock);
+
+	friend class ProgramBuilder;
+
+public:
+
+	Program();
+
+	Program(Program const &) = delete;
+	Program &operator =(Program const &) = delete;
+
+	bool IsEmpty() const
+	{
+		return blockStarts.size() <= 1;
+	}
+
+	int GetNumberOfInstructions() const
+	{
+		return (int)instructions.size();
+	}
+
+	// Number of instructions that fall back to BlockBase::Evaluate().
+	int GetNumberOfCalls() const
+	{
+		return numberOfCalls;
+	}
+
+	int GetNumberOfBlocks() const
+	{
+		return (int)blockStarts.size() - 1;
+	}
+
+	// Indicates whether the given block of the schedule is executed through
+	// a call to Evaluate().
+	bool CallsEvaluate(int block) const;
+
+	// The instructions the given block of the schedule was lowered to.
+	int GetNumberOfInstructions(int block) const
+	{
+		return blockStarts[block + 1] - blockStarts[block];
+	}
+
+	Instruction const &GetInstruction(int block, int index) const
+	{
+		return instructions[blockStarts[block] + index];
+	}
+
+	bool IsNative() const
+	{
+		return nativeFunction != nullptr;
+	}
+
+	// Replaces the execution of the whole program by native code.
+	void SetNative(NativeFunction function, std::vector<void *> const &values, std::shared_ptr<void> const &library);
+
+	// Executes the instructions of the blocks with schedule indices in the
+	// range [firstBlock, lastBlock).
+	void Execute(int firstBlock, int lastBlock) const
+	{
+		if (nativeFunction != nullptr && firstBlock == 0 && lastBlock == GetNumberOfBlocks()) {
+
+			nativeFunction(&nativeContext);
+			return;
+		}
+
+		Instruction const *instruction = instructions.data() + blockStarts[firstBlock];
+		Instruction const *end = instructions.data() + blockStarts[lastBlock];
+
+		for (; instruction != end; ++instruction)
+			instruction->execute(*instruction);
+	}
+};
+
+//
+// ProgramBuilder: passed to BlockBase::Lower() to collect the instructions
+// of a block.
+//
+
+class ProgramBuilder {
+
+private:
+
+	Program &program;
+	LaneLayout layout;
+	std::vector<int> inputOffsets;
+	std::vector<int> parameterOffsets;
+
+public:
+
+	ProgramBuilder(Program &program, LaneLayout const &layout);
+
+	ProgramBuilder(ProgramBuilder const &) = delete;
+	ProgramBuilder &operator =(ProgramBuilder const &) = delete;
+
+	LaneLayout const &GetLayout() const
+	{
+		return layout;
+	}
+
+	// Lowers the next block of the schedule. Blocks that cannot be lowered
+	// are executed through a call to Evaluate(). Returns false in that case.
+	bool Add(BlockBase *block);
+
+	// Appends an instruction. 'count' is set to the number of inputs.
+	void Emit(Kernel kernel, void *output, std::vector<void const *> const &inputs, std::vector<int> const &parameters = std::vector<int>());
+
+	// Resolves the pointers into the input and parameter pools. Must be called
+	// once after the last block was added.
+	void Finish();
+};
+
+}
+}
@@ -0,0 +1,162 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+/*
+
+	Implementation of class 'CostModel'.
+
+*/
+
+#include "global.h"
+
+namespace dfx {
+namespace backend {
+
+double const CostModel::defaultCost = 8.0;
+
+// Measured with CostModel::Calibrate() on a design with a few hundred blocks
+// of every class.
+CostModel::CostModel() :
+	costs({
+		{ "and:bool", 9.0 },
+		{ "or:bool", 9.0 },
+		{ "xor:bool", 9.0 },
+		{ "not:bool", 5.5 },
+		{ "decide:bool", 4.5 },
+		{ "bit_extract:int32", 6.5 },
+		{ "bit_extract:int64", 6.5 },
+		{ "bit_extract:dynfix", 3.5 },
+		{ "equal:double", 7.5 },
+		{ "less:double", 7.0 },
+		{ "less:int32", 7.0 },
+		{ "less:dynfix", 11.5 },
+		{ "negate:double", 5.5 },
+		{ "negate:dynfix", 3.0 },
+		{ "plus:double", 9.5 },
+		{ "plus:int32", 9.5 },
+		{ "plus:dynfix", 12.5 },
+		{ "times:double", 12.0 },
+		{ "times:int32", 9.0 },
+		{ "times:dynfix", 13.5 },
+		{ "floor_cast:double", 73.0 },
+		{ "floor_cast:dynfix", 19.0 },
+		{ "function:double", 11.5 },
+		{ "probe:bool", 4.0 },
+		{ "probe:double", 3.5 },
+		{ "signal:double", 5.0 }
+	})
+{
+}
+
+// The key combines the class of the block with the type of its first input
+// or, for blocks without inputs, of its first output. Fixed-point values are
+// counted in 32-bit words.
+void CostModel::GetKey(BlockBase const *block, std::string &key, int &words)
+{
+	types::TypeDescription type;
+	words = 1;
+
+	for (auto const *pin : block->GetOutputPins()) {
+
+		auto pinType = pin->GetType();
+
+		if (!type.IsKnown())
+			type = pinType;
+
+		if (pinType.IsClass(types::TypeDescription::FixedPoint))
+			words = std::max(words, (pinType.GetWordWidth() + 31) / 32);
+	}
+
+	for (auto const *pin : block->GetInputPins()) {
+
+		auto const *driver = pin->GetDrivingPin();
+		if (driver == nullptr)
+			continue;
+
+		auto pinType = driver->GetType();
+
+		if (pin == block->GetInputPins().front())
+			type = pinType;
+
+		if (pinType.IsClass(types::TypeDescription::FixedPoint))
+			words = std::max(words, (pinType.GetWordWidth() + 31) / 32);
+	}
+
+	key = block->GetClassName() + ":" + (type.IsClass(types::TypeDescription::FixedPoint) ? std::string("dynfix") : type.ToString());
+}
+
+double CostModel::GetCost(BlockBase const *block) const
+{
+	std::string key;
+	int words;
+	GetKey(block, key, words);
+
+	auto it = costs.find(key);
+	return (it != costs.end() ? it->second : defaultCost) * words;
+}
+
+void CostModel::Calibrate(std::vector<BlockBase *> const &blocks)
+{
+	struct Group {
+
+		std::vector<BlockBase *> blocks;
+		int words = 0;
+	};
+
+	std::map<std::string, Group> groups;
+
+	for (auto *block : blocks) {
+
+		if (!block->CanEvaluate() || block->GetStep() != nullptr)
+			continue;
+
+		std::string key;
+		int words;
+		GetKey(block, key, words);
+
+		auto &group = groups[key];
+		group.blocks.push_back(block);
+		group.words += words;
+	}
+
+	for (auto const &entry : groups) {
+
+		auto const &group = entry.second;
+
+		// About 10000 evaluations per class keep the calibration short.
+		int repetitions = std::max(1, 10000 / (int)group.blocks.size());
+
+		for (auto *block : group.blocks)
+			block->Evaluate();
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < repetitions; ++i)
+			for (auto *block : group.blocks)
+				block->Evaluate();
+
+		double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		costs[entry.first] = nanoseconds / ((double)repetitions * group.words);
+	}
+}
+
+}
+}
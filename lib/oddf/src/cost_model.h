@@ -0,0 +1,69 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Estimated evaluation cost of blocks, used by the simulator to balance the
+	work between threads. Costs are given in nanoseconds per evaluation and
+	are looked up by block class and data type. The built-in table was seeded
+	from measured Evaluate() timings and can be replaced by measurements on
+	the actual design (see Simulator::Options::calibrateCosts).
+
+*/
+
+#pragma once
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dfx {
+namespace backend {
+
+class BlockBase;
+
+class CostModel {
+
+private:
+
+	// Cost per evaluation of a block processing a single value or, for
+	// fixed-point types, a single 32-bit word of a value.
+	std::unordered_map<std::string, double> costs;
+
+	static void GetKey(BlockBase const *block, std::string &key, int &words);
+
+public:
+
+	// Cost assumed for blocks not found in the table. Also the cost of a
+	// simple block, in which 'taskSize' is given.
+	static double const defaultCost;
+
+	CostModel();
+
+	double GetCost(BlockBase const *block) const;
+
+	// Measures the cost of the given blocks by repeatedly calling Evaluate().
+	// Clocked blocks keep the estimated cost.
+	void Calibrate(std::vector<BlockBase *> const &blocks);
+};
+
+}
+}
@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cinttypes>
 #include <cmath>
 #include <condition_variable>
@@ -39,6 +40,7 @@
 #include <forward_list>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <initializer_list>
 #include <iostream>
 #include <iomanip>
@@ -66,6 +68,7 @@
 #include "bus.h"
 #include "inout.h"
 
+#include "bytecode.h"
 #include "simulator.h"
 #include "hierarchy.h"
 
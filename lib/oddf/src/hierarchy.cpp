@@ -52,7 +52,8 @@ HierarchyLevel::HierarchyLevel() :
 	name(),
 	parent(nullptr),
 	next(nullptr),
-	firstChild(nullptr)
+	firstChild(nullptr),
+	keepDuplicates(false)
 {
 }
 
@@ -97,6 +98,20 @@ HierarchyLevel *HierarchyLevel::GetParent() const
 	return parent;
 }
 
+void HierarchyLevel::SetKeepDuplicates(bool keep)
+{
+	keepDuplicates = keep;
+}
+
+bool HierarchyLevel::KeepsDuplicates() const
+{
+	for (auto *level = this; level != nullptr; level = level->parent)
+		if (level->keepDuplicates)
+			return true;
+
+	return false;
+}
+
 
 
 
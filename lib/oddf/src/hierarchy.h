@@ -47,6 +47,8 @@ private:
 	HierarchyLevel *next;
 	HierarchyLevel *firstChild;
 
+	bool keepDuplicates;
+
 	friend class Hierarchy;
 
 private:
@@ -65,6 +67,12 @@ public:
 
 	HierarchyLevel *GetParent() const;
 
+	// Prevents the simulator from merging equivalent blocks in this level and
+	// all levels below (see Simulator::Options::mergeEquivalentBlocks), e.g.
+	// if the generated netlist must keep the duplicates.
+	void SetKeepDuplicates(bool keep);
+	bool KeepsDuplicates() const;
+
 	std::string GenerateBlockName(std::string const &prefix);
 
 	HierarchyLevel(HierarchyLevel const &) = delete;
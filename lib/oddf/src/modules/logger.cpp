@@ -108,11 +108,14 @@ private:
 	std::list<InputPin<T>> inputs;
 	std::vector<T> values;
 
+	// Values handed over by swap(), which the simulator does not modify
+	std::vector<T> swappedValues;
+
 	std::string formatString;
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t();
+		return false;
 	}
 
 	bool CanEvaluate() const override
@@ -137,6 +140,16 @@ private:
 	{
 	}
 
+	void SaveState(StateWriter &writer) const override
+	{
+		writer.Write(values);
+	}
+
+	void RestoreState(StateReader &reader) override
+	{
+		reader.Read(values);
+	}
+
 	IStep *GetStep()
 	{
 		return this;
@@ -145,19 +158,28 @@ private:
 	virtual void clear() override
 	{
 		values.clear();
+		swappedValues.clear();
+	}
+
+	virtual void swap() override
+	{
+		std::swap(values, swappedValues);
+		values.clear();
 	}
 
-	virtual int get_length() const override
+	virtual int get_length(bool swapped) const override
 	{
-		return (int)(values.size() / inputs.size());
+		return (int)((swapped ? swappedValues : values).size() / inputs.size());
 	}
 
-	virtual std::vector<std::string> get_formatted_list() const override
+	virtual std::vector<std::string> get_formatted_list(bool swapped) const override
 	{
+		auto const &list = swapped ? swappedValues : values;
+
 		std::vector<std::string> elements;
-		elements.reserve(values.size());
+		elements.reserve(list.size());
 
-		for (auto const &value : values)
+		for (auto const &value : list)
 			elements.push_back(string_printf(formatString, value));
 
 		return elements;
@@ -175,6 +197,7 @@ public:
 		callback(callback),
 		inputs(),
 		values(),
+		swappedValues(),
 		formatString(formatString)
 	{
 	}
@@ -206,6 +229,7 @@ namespace modules {
 
 Logger::Logger() :
 	Enabled(true),
+	Swapped(false),
 	Columns()
 {
 }
@@ -543,6 +567,14 @@ void Logger::Clear()
 		column.Block->clear();
 }
 
+void Logger::Swap()
+{
+	for (auto &column : Columns)
+		column.Block->swap();
+
+	Swapped = true;
+}
+
 void Logger::WriteTable(std::basic_ostream<char> &os, std::unordered_set<std::string> const &tags) const
 {
 	struct FormattedColumn {
@@ -565,7 +597,7 @@ void Logger::WriteTable(std::basic_ostream<char> &os, std::unordered_set<std::st
 
 			formattedColumn.Name = column.Name + indexing_string(column.BusFlags, column.BusWidth);
 
-			formattedColumn.Elements = format_as_bus(column.Block->get_formatted_list(), column.BusWidth, column.Separation, (column.BusFlags & Flags::ReversedElementOrder) != 0);
+			formattedColumn.Elements = format_as_bus(column.Block->get_formatted_list(Swapped), column.BusWidth, column.Separation, (column.BusFlags & Flags::ReversedElementOrder) != 0);
 			formattedColumn.Width = std::max(
 				(int)formattedColumn.Name.length(),
 				max_element_width(formattedColumn.Elements)
@@ -576,10 +608,10 @@ void Logger::WriteTable(std::basic_ostream<char> &os, std::unordered_set<std::st
 			formattedColumn.Name = column.Name;
 
 			if (column.BusWidth == 1)
-				formattedColumn.Elements = column.Block->get_formatted_list();
+				formattedColumn.Elements = column.Block->get_formatted_list(Swapped);
 			else {
 
-				formattedColumn.Elements = std::vector<std::string>(column.Block->get_length(), "<sequence not supported>");
+				formattedColumn.Elements = std::vector<std::string>(column.Block->get_length(Swapped), "<sequence not supported>");
 			}
 
 			formattedColumn.Width = std::max(
@@ -665,10 +697,10 @@ void Logger::ExportToVaryPlot(std::string const &s_basePath, std::unordered_set<
 		file << std::setprecision(16);
 
 		std::vector<std::string> values = column.IsBus 
-			? format_as_bus(column.Block->get_formatted_list(), column.BusWidth, 1, false)
-			: column.Block->get_formatted_list();
+			? format_as_bus(column.Block->get_formatted_list(Swapped), column.BusWidth, 1, false)
+			: column.Block->get_formatted_list(Swapped);
 
-		numberOfClocks = std::max(numberOfClocks, column.Block->get_length());
+		numberOfClocks = std::max(numberOfClocks, column.Block->get_length(Swapped));
 
 		double clockStretch = column.IsBus
 			? 1.0
@@ -24,6 +24,10 @@
 	Content can be printed in table form or exported as a
 	machine-readable text file.
 
+	With Simulator::RunAsync(), Swap() hands the recorded content over to
+	the output functions, which can then write it while the simulator keeps
+	logging into an empty buffer.
+
 */
 
 #pragma once
@@ -41,11 +45,14 @@ public:
 	// Clear all logged data
 	virtual void clear() = 0;
 
-	// Number of elements logged
-	virtual int get_length() const = 0;
+	// Hands the logged data over to the swapped buffer and clears the data.
+	virtual void swap() = 0;
+
+	// Number of elements logged or in the swapped buffer
+	virtual int get_length(bool swapped) const = 0;
 
-	// Logged data as a vector of strings.
-	virtual std::vector<std::string> get_formatted_list() const = 0;
+	// Logged data or the swapped buffer as a vector of strings.
+	virtual std::vector<std::string> get_formatted_list(bool swapped) const = 0;
 };
 
 class logger_callback {
@@ -66,6 +73,9 @@ private:
 
 	bool Enabled;
 
+	// Set by Swap(), after which the output functions write the swapped content.
+	bool Swapped;
+
 	enum struct SignalType : int {
 
 		Boolean = 0,
@@ -154,6 +164,13 @@ public:
 	// Clears all logged content.
 	void Clear();
 
+	// Hands the content logged so far over to WriteTable() and ExportToVaryPlot()
+	// and continues logging into an empty buffer. Once Swap() was called, the
+	// output functions write only the content of the last swap and may be
+	// called during Simulator::RunAsync(). Swap() itself must not be called
+	// while a run of the simulator is in progress.
+	void Swap();
+
 	// Disables logging to save memory and speed up the simulation.
 	void Disable();
 
@@ -47,7 +47,7 @@ private:
 	int RefWidth;
 	void Evaluate() override { };
 	bool CanEvaluate() const override {	return false; }
-	source_blocks_t GetSourceBlocks() const override { return source_blocks_t(); }
+	bool IsSourcePin(InputPinBase const &) const override { return false; }
 
 public:
 	recorder_block(dfx::modules::Recorder *Recorder);
@@ -92,14 +92,12 @@ private:
 
 	void Evaluate() override
 	{
-		output.value = input.GetValue();
+		*output.valuePointer = input.GetValue();
 	}
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-		blocks.insert(input.GetDrivingBlock());
-		return blocks;
+		return true;
 	}
 
 	bool CanEvaluate() const override
@@ -116,6 +114,16 @@ private:
 	{
 	}
 
+	void SaveState(StateWriter &writer) const override
+	{
+		writer.Write(data);
+	}
+
+	void RestoreState(StateReader &reader) override
+	{
+		reader.Read(data);
+	}
+
 	IStep *GetStep() override
 	{
 		return this;
@@ -126,7 +134,7 @@ public:
 		BlockBase("stimulus"),
 		stimcheck_block_base(startIndex, getNodeWidth(in)),
 		input(this, in),
-		output(this, types::DefaultFrom(in.GetDriver()->value))
+		output(this, types::DefaultFrom(*in.GetDriver()->valuePointer))
 	{
 	};
 
@@ -172,11 +180,9 @@ private:
 
 	void Evaluate() override { }
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		source_blocks_t blocks;
-		//blocks.insert(input.GetDrivingBlock());
-		return blocks;
+		return false;
 	}
 
 	bool CanEvaluate() const override
@@ -193,6 +199,16 @@ private:
 	{
 	}
 
+	void SaveState(StateWriter &writer) const override
+	{
+		writer.Write(data);
+	}
+
+	void RestoreState(StateReader &reader) override
+	{
+		reader.Read(data);
+	}
+
 	IStep *GetStep() override
 	{
 		return this;
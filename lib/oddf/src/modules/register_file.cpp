@@ -42,9 +42,9 @@ private:
 	{
 	}
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t();
+		return false;
 	}
 
 	bool CanEvaluate() const override
@@ -62,8 +62,8 @@ public:
 
 	void Write(std::int64_t value)
 	{
-		writeOutput.value.data[0] = static_cast<std::int32_t>(value & 0xffffffff);
-		writeOutput.value.data[1] = static_cast<std::int32_t>(value >> 32);
+		writeOutput.valuePointer->data[0] = static_cast<std::int32_t>(value & 0xffffffff);
+		writeOutput.valuePointer->data[1] = static_cast<std::int32_t>(value >> 32);
 		SetDirty();
 	}
 
@@ -83,9 +83,9 @@ private:
 	{
 	}
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t();
+		return false;
 	}
 
 	bool CanEvaluate() const override
@@ -93,6 +93,11 @@ private:
 		return false;
 	}
 
+	bool IsObservable() const override
+	{
+		return true;
+	}
+
 public:
 
 	read_register_block(node<dynfix> const &source) :
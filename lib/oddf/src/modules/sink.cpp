@@ -24,6 +24,10 @@
 	cycle as determined by its 'writeEnableInput'. Collected data can be
 	copied to an std::vector after simulation.
 
+	Swap() exchanges the recorded data with a second buffer owned by the
+	user, so that the simulator keeps recording while the user processes
+	the data of the previous run.
+
 */
 
 #include "../global.h"
@@ -42,12 +46,25 @@ private:
 
 	std::list<InputPin<T>> inputs;
 
-	std::vector<T> Data;
+	// Recorded data of every lane
+	std::vector<std::vector<T>> Data;
+	LaneLayout layout;
+
+	// Data of every lane handed over to the user by Swap()
+	std::vector<std::vector<T>> swapped;
 
-	void write_next()
+	void swap()
+	{
+		std::swap(Data, swapped);
+
+		for (auto &data : Data)
+			data.clear();
+	}
+
+	void write_next(int lane)
 	{
 		for (auto &input : inputs)
-			Data.push_back(input.GetValue());
+			Data[lane].push_back(input.GetValue(layout, lane));
 	}
 
 	bool CanEvaluate() const override
@@ -61,22 +78,43 @@ private:
 
 	void Step() override
 	{
-		if (writeEnableInput.GetValue())
-			write_next();
+		for (int lane = 0; lane < (int)Data.size(); ++lane)
+			if (writeEnableInput.GetValue(layout, lane))
+				write_next(lane);
+	}
+
+	bool SetLanes(LaneLayout const &theLayout) override
+	{
+		Data.resize(theLayout.lanes);
+		swapped.resize(theLayout.lanes);
+		layout = theLayout;
+		return true;
 	}
 
 	void AsyncReset() override
 	{
 	}
 
+	void SaveState(StateWriter &writer) const override
+	{
+		for (auto const &data : Data)
+			writer.Write(data);
+	}
+
+	void RestoreState(StateReader &reader) override
+	{
+		for (auto &data : Data)
+			reader.Read(data);
+	}
+
 	IStep *GetStep()
 	{
 		return this;
 	}
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t();
+		return false;
 	}
 
 	friend class modules::Sink<T>;
@@ -88,7 +126,9 @@ public:
 		BlockBase("sink"),
 		writeEnableInput(this, writeEnable),
 		inputs(),
-		Data()
+		Data(1),
+		layout(),
+		swapped(1)
 	{
 	}
 
@@ -123,24 +163,45 @@ template<typename T> BusSink<T>::BusSink(int busWidth)
 		block.add_input(Inputs.Data(i));
 }
 
-template<typename T> std::vector<T> const &Sink<T>::GetData() const
+template<typename T> std::vector<T> const &Sink<T>::GetData(int lane /* = 0 */) const
 {
-	return Block->Data;
+	return Block->Data.at(lane);
 }
 
-template<typename T> std::vector<T> const &BusSink<T>::GetData() const
+template<typename T> std::vector<T> const &BusSink<T>::GetData(int lane /* = 0 */) const
 {
-	return Block->Data;
+	return Block->Data.at(lane);
 }
 
 template<typename T> void Sink<T>::Clear()
 {
-	Block->Data.clear();
+	for (auto &data : Block->Data)
+		data.clear();
 }
 
 template<typename T> void BusSink<T>::Clear()
 {
-	Block->Data.clear();
+	for (auto &data : Block->Data)
+		data.clear();
+}
+template<typename T> void Sink<T>::Swap()
+{
+	Block->swap();
+}
+
+template<typename T> void BusSink<T>::Swap()
+{
+	Block->swap();
+}
+
+template<typename T> std::vector<T> const &Sink<T>::GetSwappedData(int lane /* = 0 */) const
+{
+	return Block->swapped.at(lane);
+}
+
+template<typename T> std::vector<T> const &BusSink<T>::GetSwappedData(int lane /* = 0 */) const
+{
+	return Block->swapped.at(lane);
 }
 
 
@@ -24,6 +24,11 @@
 	cycle as determined by its 'writeEnableInput'. Collected data can be
 	copied to an std::vector after simulation.
 
+	For use with Simulator::RunAsync(), Swap() hands the data recorded so
+	far over to the user and continues recording into an empty buffer. The
+	swapped data belongs to the user until the next call to Swap() and can
+	be processed while the simulator runs.
+
 */
 
 #pragma once
@@ -54,9 +59,20 @@ public:
 
 	} Inputs;
 
-	class std::vector<T> const &GetData() const;
+	// Returns the data recorded in the given lane (see Simulator::Options::lanes).
+	class std::vector<T> const &GetData(int lane = 0) const;
 	void Clear();
 
+	// Exchanges the recorded data with the data returned by GetSwappedData(),
+	// which is then cleared for recording. Must not be called while a run
+	// of the simulator is in progress.
+	void Swap();
+
+	// Returns the data of the given lane handed over by the last call to
+	// Swap(). It is not modified by the simulator and can be read during
+	// Simulator::RunAsync().
+	class std::vector<T> const &GetSwappedData(int lane = 0) const;
+
 	Sink();
 };
 
@@ -77,9 +93,20 @@ public:
 
 	} Inputs;
 
-	class std::vector<T> const &GetData() const;
+	// Returns the data recorded in the given lane (see Simulator::Options::lanes).
+	class std::vector<T> const &GetData(int lane = 0) const;
 	void Clear();
 
+	// Exchanges the recorded data with the data returned by GetSwappedData(),
+	// which is then cleared for recording. Must not be called while a run
+	// of the simulator is in progress.
+	void Swap();
+
+	// Returns the data of the given lane handed over by the last call to
+	// Swap(). It is not modified by the simulator and can be read during
+	// Simulator::RunAsync().
+	class std::vector<T> const &GetSwappedData(int lane = 0) const;
+
 	BusSink(int busWidth);
 };
 
@@ -54,44 +54,60 @@ private:
 	std::list<OutputPin<T>> outputs;
 	OutputPin<bool> outputReadyOutput;
 
-	std::vector<typename replacement<T>::type> values;
+	// Read state of one lane of the simulation
+	struct Lane {
+
+		std::vector<typename replacement<T>::type> values;
+
+		std::vector<T> data;
+		size_t dataPointer;
+		bool DataReady;
+		bool dataPeriodic;
+
+		Lane(unsigned width) :
+			values(width, T()),
+			data(),
+			dataPointer(0),
+			DataReady(false),
+			dataPeriodic(false)
+		{
+		}
+	};
 
-	std::vector<T> data;
-	size_t dataPointer;
-	bool DataReady;
-	bool dataPeriodic;
+	std::vector<Lane> lanes;
+	LaneLayout layout;
 
-	void read_next()
+	static void read_next(Lane &lane)
 	{
-		DataReady = false;
+		lane.DataReady = false;
 
-		size_t length = data.size();
+		size_t length = lane.data.size();
 
 		if (length == 0)
 			return;
 
-		size_t width = values.size();
+		size_t width = lane.values.size();
 
-		if (dataPeriodic) {
+		if (lane.dataPeriodic) {
 
-			for (auto &val : values) {
+			for (auto &val : lane.values) {
 
-				if (dataPointer >= length)
-					dataPointer = 0;
+				if (lane.dataPointer >= length)
+					lane.dataPointer = 0;
 
-				val = data[dataPointer++];
+				val = lane.data[lane.dataPointer++];
 			}
 		}
 		else {
 
-			if (dataPointer + width > length)
+			if (lane.dataPointer + width > length)
 				return;
 
-			for (auto &val : values)
-				val = data[dataPointer++];
+			for (auto &val : lane.values)
+				val = lane.data[lane.dataPointer++];
 		}
 
-		DataReady = true;
+		lane.DataReady = true;
 	}
 
 	bool CanEvaluate() const override
@@ -101,57 +117,119 @@ private:
 
 	void Evaluate() override
 	{
-		size_t width = values.size();
-		auto outputIt = outputs.begin();
+		for (int l = 0; l < layout.lanes; ++l) {
 
-		if (DataReady) {
+			auto const &lane = lanes[l];
+			size_t width = lane.values.size();
+			auto outputIt = outputs.begin();
 
-			// If we have enough data available, set OutputReady to true and copy the values to the output bus.
-			outputReadyOutput.value = true;
-			for (unsigned i = 0; i < width; ++i)
-				(outputIt++)->value = replacement<T>::cast(values[i]);
-		}
-		else {
+			if (lane.DataReady) {
+
+				// If we have enough data available, set OutputReady to true and copy the values to the output bus.
+				layout.Set(outputReadyOutput.valuePointer, l, true);
+				for (unsigned i = 0; i < width; ++i)
+					layout.Set((outputIt++)->valuePointer, l, T(replacement<T>::cast(lane.values[i])));
+			}
+			else {
 
-			// If there is no or insufficient data available, set OutputReady to false and set to output bus to 0.
-			outputReadyOutput.value = false;
-			for (unsigned i = 0; i < width; ++i)
-				(outputIt++)->value = T();
+				// If there is no or insufficient data available, set OutputReady to false and set to output bus to 0.
+				layout.Set(outputReadyOutput.valuePointer, l, false);
+				for (unsigned i = 0; i < width; ++i)
+					layout.Set((outputIt++)->valuePointer, l, T());
+			}
 		}
 	}
 
 	void Step() override
 	{
-		if (readEnableInput.GetValue()) {
+		bool changed = false;
 
-			read_next();
-			SetDirty();
+		for (int l = 0; l < layout.lanes; ++l) {
+
+			if (readEnableInput.GetValue(layout, l)) {
+
+				read_next(lanes[l]);
+				changed = true;
+			}
 		}
+
+		if (changed)
+			SetDirty();
 	}
 
 	void AsyncReset() override
 	{
-		dataPointer = 0;
-		read_next();
+		for (auto &lane : lanes) {
+
+			lane.dataPointer = 0;
+			read_next(lane);
+		}
+
+		SetDirty();
+	}
+
+	// The data itself is provided by the user and not part of the state.
+	void SaveState(StateWriter &writer) const override
+	{
+		for (auto const &lane : lanes) {
+
+			writer.Write(lane.values);
+			writer.Write((std::uint64_t)lane.dataPointer);
+			writer.Write(lane.DataReady);
+		}
+	}
+
+	void RestoreState(StateReader &reader) override
+	{
+		for (auto &lane : lanes) {
+
+			std::uint64_t dataPointer;
+
+			reader.Read(lane.values);
+			reader.Read(dataPointer);
+			reader.Read(lane.DataReady);
+
+			if (dataPointer > lane.data.size())
+				StateReader::Mismatch(("read position of source '" + GetFullName() + "'").c_str());
+
+			lane.dataPointer = (size_t)dataPointer;
+		}
+
 		SetDirty();
 	}
 
+	bool SetLanes(LaneLayout const &theLayout) override
+	{
+		if ((int)lanes.size() > theLayout.lanes)
+			throw design_error("Source module: data was set for lane " + std::to_string(lanes.size() - 1) + ", but the simulator runs " + std::to_string(theLayout.lanes) + " lane(s).");
+
+		// Lanes without data of their own replay the data of the first lane.
+		lanes.resize(theLayout.lanes, lanes.front());
+		layout = theLayout;
+		return true;
+	}
+
 	IStep *GetStep()
 	{
 		return this;
 	}
 
-	source_blocks_t GetSourceBlocks() const override
+	bool IsSourcePin(InputPinBase const &) const override
 	{
-		return source_blocks_t();
+		return false;
 	}
 
-	void set_data(std::vector<T> &&newData, bool periodic)
+	void set_data(int l, std::vector<T> &&newData, bool periodic)
 	{
-		data = std::move(newData);
-		dataPointer = 0;
-		dataPeriodic = periodic;
-		read_next();
+		if (l >= (int)lanes.size())
+			lanes.resize(l + 1, Lane((unsigned)outputs.size()));
+
+		auto &lane = lanes[l];
+
+		lane.data = std::move(newData);
+		lane.dataPointer = 0;
+		lane.dataPeriodic = periodic;
+		read_next(lane);
 
 		SetDirty();
 	}
@@ -165,16 +243,13 @@ public:
 		readEnableInput(this, readEnable),
 		outputs(),
 		outputReadyOutput(this, false),
-		values(width, T()),
-		data(),
-		dataPointer(0),
-		DataReady(false),
-		dataPeriodic(false)
+		lanes(1, Lane(width)),
+		layout()
 	{
 		while (width-- > 0)
 			outputs.emplace_back(this, T());
 
-		read_next();
+		read_next(lanes.front());
 	}
 
 	bus<T> get_output_bus()
@@ -213,12 +288,17 @@ template<typename T> Source<T>::Source(int busWidth /* = 1 */)
 
 template<typename T> void Source<T>::SetData(class std::vector<T> const &data, bool periodic /* = false */)
 {
-	Block->set_data(std::vector<T>(data), periodic);
+	Block->set_data(0, std::vector<T>(data), periodic);
 }
 
 template<typename T> void Source<T>::SetData(class std::vector<T> &&data, bool periodic /* = false */)
 {
-	Block->set_data(std::move(data), periodic);
+	Block->set_data(0, std::move(data), periodic);
+}
+
+template<typename T> void Source<T>::SetData(int lane, class std::vector<T> const &data, bool periodic /* = false */)
+{
+	Block->set_data(lane, std::vector<T>(data), periodic);
 }
 
 // explicit template implementations
@@ -69,6 +69,10 @@ public:
 
 	void SetData(class std::vector<T> const &data, bool periodic = false);
 	void SetData(class std::vector<T> &&data, bool periodic = false);
+
+	// Sets the data of the given lane (see Simulator::Options::lanes). Lanes
+	// without data of their own replay the data of lane 0.
+	void SetData(int lane, class std::vector<T> const &data, bool periodic = false);
 };
 
 }
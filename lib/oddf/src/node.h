@@ -32,6 +32,8 @@
 #include "block_base.h"
 #include "messages.h"
 #include "types.h"
+#include "value_arena.h"
+#include "state.h"
 
 #if defined(_MSC_VER) && _MSC_VER < 1900
 #define NOEXCEPT
@@ -211,6 +213,30 @@ public:
 	virtual bool IsConnected() const = 0;
 	virtual types::TypeDescription GetType() const = 0;
 
+	// Returns the address of the value of this pin. Used by code generators
+	// that access the values directly.
+	virtual void *GetValueAddress() = 0;
+
+	// Moves the value of this pin into the arena of a simulator and back.
+	// Reserve() must be called for all pins before the first Relocate().
+	virtual void Reserve(ValueArena &arena) const = 0;
+	virtual void Relocate(ValueArena &arena) = 0;
+	virtual void Restore(ValueArena const &arena) = 0;
+
+	// Writes and reads the values of all lanes of a relocated pin (see
+	// Simulator::SaveState()).
+	virtual void SaveValue(StateWriter &writer, ValueArena const &arena) const = 0;
+	virtual void RestoreValue(StateReader &reader, ValueArena const &arena) = 0;
+
+	// Compares the value of a relocated single-lane pin with the value seen by
+	// the previous call and remembers it. Returns 'true' if it changed. Used
+	// by event-driven evaluation (see Simulator::Options::eventDriven).
+	virtual bool DetectChange() = 0;
+
+	// Connects all inputs driven by this pin to 'target', which must be of
+	// the same type. Used by the simulator to merge equivalent blocks.
+	virtual void MoveDrivenPins(OutputPinBase &target) = 0;
+
 	std::string GetName() const
 	{
 		int groupIndex = 0, busSize = 0, busIndex = 0;
@@ -226,6 +252,12 @@ public:
 	{
 		return owner;
 	}
+
+	// Position of the pin among the outputs of its owner.
+	int GetIndex() const
+	{
+		return index;
+	}
 };
 
 template<typename T>
@@ -243,18 +275,81 @@ private:
 	friend class temporary_block<T>;
 	friend class identity_block<T>;
 
+	// Holds the value while the pin is not part of a simulation.
+	ALIGN T storage;
+
 public:
 
-	ALIGN T value;
+	// Points to the current value of the pin, which is either 'storage' or
+	// a slot in the value arena of the simulator, which holds the values of
+	// all lanes (see LaneLayout). Code that only reads the value uses
+	// GetValue().
+	T *valuePointer;
 
 	OutputPin(BlockBase *owner, T const &init);
 	virtual ~OutputPin();
 
 	node<T> GetNode();
 
+	// Returns the current value of the pin. Outside a simulation, this is
+	// the value given at construction, e.g. to derive the type of a node.
+	T const &GetValue() const
+	{
+		return *valuePointer;
+	}
+
 	bool IsConnected() const override;
 	types::TypeDescription GetType() const override;
 
+	int GetNumberOfDrivenPins() const
+	{
+		return (int)drivenPins.size();
+	}
+
+	void *GetValueAddress() override
+	{
+		return valuePointer;
+	}
+
+	void Reserve(ValueArena &arena) const override
+	{
+		arena.Reserve<T>();
+	}
+
+	void Relocate(ValueArena &arena) override
+	{
+		valuePointer = arena.Allocate<T>(*valuePointer);
+	}
+
+	void Restore(ValueArena const &arena) override
+	{
+		storage = arena.GetLayout().Get(valuePointer, 0);
+		valuePointer = &storage;
+	}
+
+	void SaveValue(StateWriter &writer, ValueArena const &arena) const override
+	{
+		writer.Write(valuePointer, arena.GetLayout().GetSize<T>());
+	}
+
+	void RestoreValue(StateReader &reader, ValueArena const &arena) override
+	{
+		reader.Read(valuePointer, arena.GetLayout().GetSize<T>());
+	}
+
+	// The previous value is kept in 'storage', which is unused while the
+	// value is relocated.
+	bool DetectChange() override
+	{
+		if (types::IsEqual(storage, *valuePointer))
+			return false;
+
+		types::Copy(storage, *valuePointer);
+		return true;
+	}
+
+	void MoveDrivenPins(OutputPinBase &target) override;
+
 	OutputPin(OutputPin<T> const &) = delete;
 	OutputPin(OutputPin<T> &&) = delete;
 	void operator =(OutputPin<T> const &) = delete;
@@ -299,6 +394,7 @@ public:
 	}
 
 	virtual OutputPinBase const *GetDrivingPin() const = 0;
+	virtual BlockBase *GetDrivingBlock() const = 0;
 };
 
 template<typename T>
@@ -323,10 +419,16 @@ public:
 
 	T const &GetValue() const
 	{
-		return driver->value;
+		return *driver->valuePointer;
+	}
+
+	// Returns the value of the given lane (see Simulator::Options::lanes).
+	T GetValue(LaneLayout const &layout, int lane) const
+	{
+		return layout.Get(driver->valuePointer, lane);
 	}
 
-	BlockBase *GetDrivingBlock() const
+	BlockBase *GetDrivingBlock() const override
 	{
 		if (driver)
 			return driver->owner;
@@ -361,7 +463,7 @@ class temporary_block : public BlockBase {
 
 private:
 
-	source_blocks_t GetSourceBlocks() const override;
+	bool IsSourcePin(InputPinBase const &pin) const override;
 	bool IsTemporary() const override;
 
 	bool CanEvaluate() const override;
@@ -388,7 +490,7 @@ private:
 	InputPin<T> Input;
 	OutputPin<T> Output;
 
-	source_blocks_t GetSourceBlocks() const override;
+	bool IsSourcePin(InputPinBase const &pin) const override;
 	void Simplify() override;
 
 	bool CanEvaluate() const override;
@@ -464,9 +566,9 @@ inline void node<T>::operator <<=(node<T> const &rhs)
 		// Example: node<double> n = constant(1.0); n <<= otherNode; // throws this exception
 		throw design_error("Operator <<= : this operator can only be used if the left-hand side node has no driver.");
 
-	if (!types::IsCompatible(driver->value, rhs.GetDriver()->value))
+	if (!types::IsCompatible(*driver->valuePointer, *rhs.GetDriver()->valuePointer))
 		throw design_error("Operator <<= : requires both side to have the same type. Here you are trying to do '" +
-		types::GetDescription(driver->value).ToString() + "' <<= '" + types::GetDescription(rhs.GetDriver()->value).ToString() + "'.");
+		types::GetDescription(*driver->valuePointer).ToString() + "' <<= '" + types::GetDescription(*rhs.GetDriver()->valuePointer).ToString() + "'.");
 
 	// We take all pin driven by this node an connect them to the OutputPin of 'rhs'.
 	while (!driver->drivenPins.empty())
@@ -484,14 +586,14 @@ inline void node<T>::operator <<=(node<T> const &rhs)
 template<typename T>
 inline forward_node<T>::forward_node() : node<internalType>(&Design::GetCurrent().NewBlock<backend::temporary_block<internalType>>(T()).Output)
 {
-	if (!types::IsInitialised(this->driver->value))
+	if (!types::IsInitialised(*this->driver->valuePointer))
 		throw design_error("The given data type cannot be used with forward_node.");
 }
 
 template<typename T>
 inline forward_node<T>::forward_node(internalType const &templateType) : node<internalType>(&Design::GetCurrent().NewBlock<backend::temporary_block<internalType>>(templateType).Output)
 {
-	if (!types::IsInitialised(this->driver->value))
+	if (!types::IsInitialised(*this->driver->valuePointer))
 		throw design_error("The given data type cannot be used with forward_node.");
 }
 
@@ -525,7 +627,8 @@ template<typename T>
 inline OutputPin<T>::OutputPin(BlockBase *owner, T const &init) :
 	OutputPinBase(owner),
 	drivenPins(),
-	value(init)
+	storage(init),
+	valuePointer(&storage)
 {
 }
 
@@ -549,6 +652,17 @@ inline void OutputPin<T>::UnregisterPin(InputPin<T> *pin)
 	drivenPins.erase(std::find(std::begin(drivenPins), std::end(drivenPins), pin));
 }
 
+template<typename T>
+inline void OutputPin<T>::MoveDrivenPins(OutputPinBase &target)
+{
+	auto &other = static_cast<OutputPin<T> &>(target);
+
+	for (auto *pin : drivenPins)
+		pin->driver = &other;
+
+	other.drivenPins.splice(other.drivenPins.end(), drivenPins);
+}
+
 template<typename T>
 inline node<T> OutputPin<T>::GetNode()
 {
@@ -564,7 +678,7 @@ inline bool OutputPin<T>::IsConnected() const
 template<typename T>
 inline types::TypeDescription OutputPin<T>::GetType() const
 {
-	return types::GetDescription(value);
+	return types::GetDescription(*valuePointer);
 }
 
 
@@ -614,6 +728,25 @@ inline void InputPin<T>::Connect(node<T> const &Other)
 }
 
 
+//
+// backend::BlockBase template implementation
+//
+
+template<typename visitorT>
+inline void BlockBase::ForEachSourceBlock(visitorT &&visit) const
+{
+	for (auto *pin : inputPins) {
+
+		if (IsSourcePin(*pin)) {
+
+			auto *source = pin->GetDrivingBlock();
+			if (source)
+				visit(source);
+		}
+	}
+}
+
+
 //
 // backend::temporary_block<T> implementation
 //
@@ -649,9 +782,9 @@ inline void temporary_block<T>::Evaluate()
 }
 
 template<typename T>
-inline BlockBase::source_blocks_t temporary_block<T>::GetSourceBlocks() const
+inline bool temporary_block<T>::IsSourcePin(InputPinBase const &) const
 {
-	return source_blocks_t();
+	return false;
 }
 
 template<typename T>
@@ -670,7 +803,7 @@ template<typename T>
 inline identity_block<T>::identity_block(node<T> const &other) :
 	BlockBase("identity"),
 	Input(this, other),
-	Output(this, Input.driver->value)
+	Output(this, *Input.driver->valuePointer)
 {
 }
 
@@ -683,19 +816,19 @@ inline bool identity_block<T>::CanEvaluate() const
 template<typename T>
 inline void identity_block<T>::Evaluate()
 {
-	Output.value = Input.GetValue();
+	*Output.valuePointer = Input.GetValue();
 }
 
 template<typename T>
-inline BlockBase::source_blocks_t identity_block<T>::GetSourceBlocks() const
+inline bool identity_block<T>::IsSourcePin(InputPinBase const &) const
 {
 	if (Input.GetDrivingBlock() != nullptr) {
 
 		design_info(GetFullName() + ": identity block was not removed during execution graph optimisation.");
-		return source_blocks_t({ Input.GetDrivingBlock() });
+		return true;
 	}
 	else
-		return source_blocks_t();
+		return false;
 }
 
 template<typename T>
@@ -0,0 +1,146 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Implementation of class 'RegisterBank'.
+
+*/
+
+#include "global.h"
+
+namespace dfx {
+namespace backend {
+
+RegisterBank::RegisterBank() :
+	groupMap(),
+	groups(),
+	allocated(false)
+{
+}
+
+RegisterBank::~RegisterBank()
+{
+	Restore();
+}
+
+void RegisterBank::Allocate()
+{
+	assert(!allocated);
+
+	// Largest groups first, so that the threads of the step phase start with
+	// the most work.
+	for (auto &entry : groupMap)
+		groups.push_back(entry.second.get());
+
+	std::stable_sort(groups.begin(), groups.end(), [](GroupBase const *a, GroupBase const *b) { return a->GetSize() > b->GetSize(); });
+
+	for (auto *group : groups)
+		group->Allocate();
+
+	allocated = true;
+}
+
+void RegisterBank::Restore()
+{
+	if (!allocated)
+		return;
+
+	for (auto *group : groups)
+		group->Restore();
+
+	groups.clear();
+	groupMap.clear();
+	allocated = false;
+}
+
+int RegisterBank::GetNumberOfGroups() const
+{
+	return (int)groups.size();
+}
+
+int RegisterBank::GetNumberOfRegisters() const
+{
+	int result = 0;
+	for (auto const *group : groups)
+		result += group->GetSize();
+
+	return result;
+}
+
+int RegisterBank::GetNumberOfLines() const
+{
+	int result = 0;
+	for (auto const *group : groups)
+		result += group->GetNumberOfLines();
+
+	return result;
+}
+
+int RegisterBank::GetNumberOfLineRegisters() const
+{
+	int result = 0;
+	for (auto const *group : groups)
+		result += group->GetNumberOfLineRegisters();
+
+	return result;
+}
+
+// The states are part of the bank, not of the simulated state, which
+// does not change.
+void RegisterBank::Synchronise() const
+{
+	for (auto *group : groups)
+		group->Synchronise();
+}
+
+void RegisterBank::Reload()
+{
+	for (auto *group : groups)
+		group->Reload();
+}
+
+void RegisterBank::StepGroup(int index)
+{
+	groups[index]->Step();
+}
+
+std::type_index RegisterBank::GetGroupType(int index) const
+{
+	return groups[index]->GetType();
+}
+
+std::vector<std::pair<int, int>> RegisterBank::GetOwnerRanges(int index) const
+{
+	return groups[index]->GetOwnerRanges();
+}
+
+void RegisterBank::SetNativeStep(int index, NativeStepFunction function, std::shared_ptr<void> const &library)
+{
+	groups[index]->SetNative(function, library);
+}
+
+bool RegisterBank::IsUntapped(void const *output) const
+{
+	return std::any_of(groups.begin(), groups.end(), [output](GroupBase const *group) { return group->IsUntapped(output); });
+}
+
+}
+}
@@ -0,0 +1,532 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Contiguous storage for the states of delay blocks. Delay blocks hand
+	their states over to the register bank of a simulator, which keeps the
+	states of the same type and enable signal in one array next to the
+	addresses of their inputs. The step phase then takes over all inputs of
+	such a group in a single loop instead of one virtual call per block, and
+	skips groups whose enable signal is low.
+
+	Chains of delays, in which every delay takes the output of the previous
+	one, are kept as delay lines: a ring buffer with a moving head, so that a
+	clock cycle writes one value instead of moving every stage. Only the
+	stages whose outputs are read by other blocks are loaded into their
+	states.
+
+	The native backend (see lib/native) can replace the loop over the
+	registers of a group that are not part of a delay line by generated
+	code.
+
+*/
+
+#pragma once
+
+#include "block_base.h"
+#include "types.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dfx {
+namespace backend {
+
+// Arguments of natively compiled step code for a group of the register bank
+// (see lib/native). The generated code declares a layout-compatible structure.
+struct NativeStepContext {
+
+	// The states of the group and the addresses of the inputs of its
+	// registers.
+	void *states;
+	void const *const *inputs;
+
+	// Activity counters and blocks of the owners of the registers in the
+	// order of RegisterBank::GetOwnerRanges().
+	StepActivity *const *activities;
+	BlockBase *const *blocks;
+	void (*setDirty)(BlockBase *block);
+};
+
+using NativeStepFunction = void (*)(NativeStepContext const *context);
+
+class RegisterBank {
+
+private:
+
+	// Chains of at least this many delays become delay lines.
+	static int const minimumLineLength = 4;
+
+	class GroupBase {
+
+	public:
+
+		// Value of the enable signal or nullptr if the group is always enabled.
+		bool const *enable;
+
+		GroupBase(bool const *theEnable) : enable(theEnable) {}
+		virtual ~GroupBase() {}
+
+		virtual void Allocate() = 0;
+		virtual void Restore() = 0;
+		virtual void Step() = 0;
+		virtual void Synchronise() = 0;
+		virtual void Reload() = 0;
+		virtual int GetSize() const = 0;
+		virtual int GetNumberOfLines() const = 0;
+		virtual int GetNumberOfLineRegisters() const = 0;
+		virtual bool IsUntapped(void const *output) const = 0;
+		virtual std::type_index GetType() const = 0;
+		virtual std::vector<std::pair<int, int>> GetOwnerRanges() const = 0;
+		virtual void SetNative(NativeStepFunction function, std::shared_ptr<void> const &library) = 0;
+	};
+
+	template<typename T>
+	class Group : public GroupBase {
+
+	private:
+
+		// The registers [begin, end) of one block that are stepped one by one,
+		// or the register of a tapped stage of a delay line.
+		struct Owner {
+
+			BlockBase *block;
+			StepActivity *activity;
+			int begin;
+			int end;
+		};
+
+		// A delay line keeps the states of its stages in 'rings' from
+		// 'offset' on, stage k at position (head + k) % 'registers.size()'.
+		// 'input' is the input of the first stage.
+		struct Line {
+
+			int offset;
+			int head;
+			T const *input;
+			std::vector<int> registers;
+			std::vector<std::pair<int, Owner>> taps;
+		};
+
+		// The state pointers of the delay blocks, which point into 'states'
+		// while the bank exists, and the storage they point to otherwise.
+		std::vector<T **> slots;
+		std::vector<T *> homes;
+
+		std::unique_ptr<T[]> states;
+		std::vector<T const *> inputs;
+
+		// Output values of the registers and whether the following register
+		// is their only reader.
+		std::vector<T *> outputs;
+		std::vector<bool> exclusive;
+
+		std::vector<BlockBase *> blocks;
+		std::vector<StepActivity *> activities;
+
+		std::vector<Owner> owners;
+		std::vector<Line> lines;
+		std::unique_ptr<T[]> rings;
+
+		// Generated replacement for StepOwners() and the tables it reads.
+		// 'nativeLibrary' keeps the code loaded.
+		NativeStepFunction nativeStep;
+		NativeStepContext nativeContext;
+		std::vector<void const *> nativeInputs;
+		std::vector<StepActivity *> nativeActivities;
+		std::vector<BlockBase *> nativeBlocks;
+		std::shared_ptr<void> nativeLibrary;
+
+		void BuildLines()
+		{
+			int size = (int)inputs.size();
+
+			// Registers that share their block with others are stepped one by one.
+			std::vector<bool> single(size, false);
+			for (int i = 0; i < size; ++i)
+				single[i] = (i == 0 || blocks[i - 1] != blocks[i]) && (i + 1 == size || blocks[i + 1] != blocks[i]);
+
+			std::unordered_map<T const *, int> registerByOutput;
+			for (int i = 0; i < size; ++i)
+				if (single[i])
+					registerByOutput[outputs[i]] = i;
+
+			std::vector<int> successors(size, -1);
+			std::vector<bool> followers(size, false);
+
+			for (int i = 0; i < size; ++i) {
+
+				if (!single[i])
+					continue;
+
+				auto it = registerByOutput.find(inputs[i]);
+
+				if (it != registerByOutput.end() && it->second != i && successors[it->second] == -1) {
+
+					successors[it->second] = i;
+					followers[i] = true;
+				}
+			}
+
+			// Chains start at registers that do not follow another one. Closed
+			// loops of delays have no start and are stepped one by one.
+			std::vector<bool> inLine(size, false);
+			int ringSize = 0;
+
+			for (int i = 0; i < size; ++i) {
+
+				if (!single[i] || followers[i] || successors[i] == -1)
+					continue;
+
+				Line line = { ringSize, 0, inputs[i], {}, {} };
+
+				for (int k = i; k != -1; k = successors[k])
+					line.registers.push_back(k);
+
+				if ((int)line.registers.size() < minimumLineLength)
+					continue;
+
+				for (int k = 0; k < (int)line.registers.size(); ++k) {
+
+					int index = line.registers[k];
+					inLine[index] = true;
+
+					if (!exclusive[index] || successors[index] == -1)
+						line.taps.push_back({ k, { blocks[index], activities[index], index, index + 1 } });
+				}
+
+				ringSize += (int)line.registers.size();
+				lines.push_back(std::move(line));
+			}
+
+			for (int i = 0; i < size; ++i) {
+
+				if (inLine[i])
+					continue;
+
+				if (owners.empty() || owners.back().block != blocks[i] || owners.back().end != i)
+					owners.push_back({ blocks[i], activities[i], i, i });
+
+				owners.back().end = i + 1;
+			}
+
+			rings.reset(new T[ringSize]);
+		}
+
+		void StepOwners()
+		{
+			for (auto const &owner : owners) {
+
+				bool changed = false;
+
+				for (int i = owner.begin; i < owner.end; ++i) {
+
+					if (!types::IsEqual(states[i], *inputs[i])) {
+
+						changed = true;
+						types::Copy(states[i], *inputs[i]);
+					}
+				}
+
+				++owner.activity->steps;
+
+				if (changed) {
+
+					++owner.activity->changes;
+					owner.block->SetDirty();
+				}
+			}
+		}
+
+		static void SetDirty(BlockBase *block)
+		{
+			block->SetDirty();
+		}
+
+		static void StepRegister(Owner const &owner, T &state, T const &value)
+		{
+			++owner.activity->steps;
+
+			if (!types::IsEqual(state, value)) {
+
+				types::Copy(state, value);
+				++owner.activity->changes;
+				owner.block->SetDirty();
+			}
+		}
+
+	public:
+
+		Group(bool const *theEnable) :
+			GroupBase(theEnable), slots(), homes(), states(), inputs(), outputs(), exclusive(), blocks(), activities(), owners(), lines(), rings(),
+			nativeStep(nullptr), nativeContext(), nativeInputs(), nativeActivities(), nativeBlocks(), nativeLibrary()
+		{
+		}
+
+		void Add(BlockBase *block, StepActivity *activity, T *&state, T const *input, T *output, bool isExclusive)
+		{
+			slots.push_back(&state);
+			homes.push_back(state);
+			inputs.push_back(input);
+			outputs.push_back(output);
+			exclusive.push_back(isExclusive);
+			blocks.push_back(block);
+			activities.push_back(activity);
+		}
+
+		void Allocate() override
+		{
+			states.reset(new T[slots.size()]);
+
+			// Assigned rather than copied by types::Copy(), which leaves out
+			// the format of dynfix values.
+			for (std::size_t i = 0; i < slots.size(); ++i) {
+
+				states[i] = *homes[i];
+				*slots[i] = &states[i];
+			}
+
+			BuildLines();
+			Reload();
+		}
+
+		void Restore() override
+		{
+			Synchronise();
+
+			for (std::size_t i = 0; i < slots.size(); ++i) {
+
+				types::Copy(*homes[i], states[i]);
+				*slots[i] = homes[i];
+			}
+		}
+
+		void Step() override
+		{
+			if (enable != nullptr && !*enable) {
+
+				for (auto const &owner : owners)
+					++owner.activity->steps;
+
+				for (auto const &line : lines)
+					for (auto const &tap : line.taps)
+						++tap.second.activity->steps;
+
+				return;
+			}
+
+			if (nativeStep != nullptr)
+				nativeStep(&nativeContext);
+			else
+				StepOwners();
+
+			for (auto &line : lines) {
+
+				T *ring = rings.get() + line.offset;
+				int length = (int)line.registers.size();
+
+				line.head = (line.head == 0 ? length : line.head) - 1;
+				types::Copy(ring[line.head], *line.input);
+
+				for (auto const &tap : line.taps) {
+
+					int position = line.head + tap.first;
+					if (position >= length)
+						position -= length;
+
+					StepRegister(tap.second, states[tap.second.begin], ring[position]);
+				}
+			}
+		}
+
+		// Loads the states and outputs of all stages of the delay lines, which
+		// are otherwise only kept for the tapped stages.
+		void Synchronise() override
+		{
+			for (auto const &line : lines) {
+
+				T const *ring = rings.get() + line.offset;
+				int length = (int)line.registers.size();
+
+				for (int k = 0; k < length; ++k) {
+
+					int index = line.registers[k];
+
+					types::Copy(states[index], ring[(line.head + k) % length]);
+					types::Copy(*outputs[index], states[index]);
+				}
+			}
+		}
+
+		// Fills the delay lines from the states after these were written by
+		// the blocks.
+		void Reload() override
+		{
+			for (auto &line : lines) {
+
+				T *ring = rings.get() + line.offset;
+
+				line.head = 0;
+
+				for (int k = 0; k < (int)line.registers.size(); ++k)
+					ring[k] = states[line.registers[k]];
+			}
+		}
+
+		int GetSize() const override
+		{
+			return (int)inputs.size();
+		}
+
+		int GetNumberOfLines() const override
+		{
+			return (int)lines.size();
+		}
+
+		int GetNumberOfLineRegisters() const override
+		{
+			int result = 0;
+			for (auto const &line : lines)
+				result += (int)line.registers.size();
+
+			return result;
+		}
+
+		bool IsUntapped(void const *output) const override
+		{
+			for (auto const &line : lines) {
+
+				for (int k = 0; k < (int)line.registers.size(); ++k) {
+
+					if (outputs[line.registers[k]] != output)
+						continue;
+
+					return std::none_of(line.taps.begin(), line.taps.end(), [k](std::pair<int, Owner> const &tap) { return tap.first == k; });
+				}
+			}
+
+			return false;
+		}
+
+		std::type_index GetType() const override
+		{
+			return std::type_index(typeid(T));
+		}
+
+		std::vector<std::pair<int, int>> GetOwnerRanges() const override
+		{
+			std::vector<std::pair<int, int>> ranges;
+
+			for (auto const &owner : owners)
+				ranges.emplace_back(owner.begin, owner.end);
+
+			return ranges;
+		}
+
+		void SetNative(NativeStepFunction function, std::shared_ptr<void> const &library) override
+		{
+			nativeInputs.assign(inputs.begin(), inputs.end());
+			nativeActivities.clear();
+			nativeBlocks.clear();
+
+			for (auto const &owner : owners) {
+
+				nativeActivities.push_back(owner.activity);
+				nativeBlocks.push_back(owner.block);
+			}
+
+			nativeContext.states = states.get();
+			nativeContext.inputs = nativeInputs.data();
+			nativeContext.activities = nativeActivities.data();
+			nativeContext.blocks = nativeBlocks.data();
+			nativeContext.setDirty = &SetDirty;
+
+			nativeStep = function;
+			nativeLibrary = library;
+		}
+	};
+
+	std::map<std::pair<std::type_index, bool const *>, std::unique_ptr<GroupBase>> groupMap;
+	std::vector<GroupBase *> groups;
+	bool allocated;
+
+public:
+
+	RegisterBank();
+	~RegisterBank();
+
+	RegisterBank(RegisterBank const &) = delete;
+	RegisterBank &operator =(RegisterBank const &) = delete;
+
+	// Adds a register with a single-lane state. 'state' is redirected to the
+	// bank by Allocate() and back by Restore(). 'enable' is nullptr for
+	// registers that take their input in every clock cycle. 'output' is the
+	// value the block loads the state into, and 'exclusive' indicates that
+	// it is read by a single input.
+	template<typename T>
+	void Add(BlockBase *block, StepActivity *activity, T *&state, T const *input, T *output, bool exclusive, bool const *enable)
+	{
+		assert(!allocated);
+
+		auto &group = groupMap[std::make_pair(std::type_index(typeid(T)), enable)];
+		if (!group)
+			group = std::make_unique<Group<T>>(enable);
+
+		static_cast<Group<T> &>(*group).Add(block, activity, state, input, output, exclusive);
+	}
+
+	// Moves all states into the bank once all registers are added. The states
+	// are moved back to the blocks by Restore() or on destruction.
+	void Allocate();
+	void Restore();
+
+	// Brings the states and outputs of all registers up to date before they
+	// are read other than by the simulation, and the delay lines after the
+	// states were written.
+	void Synchronise() const;
+	void Reload();
+
+	// The groups are the unit of work in the step phase.
+	int GetNumberOfGroups() const;
+	int GetNumberOfRegisters() const;
+	int GetNumberOfLines() const;
+	int GetNumberOfLineRegisters() const;
+	void StepGroup(int index);
+
+	// Indicates whether 'output' is the output value of a stage of a delay
+	// line that is not loaded during the simulation.
+	bool IsUntapped(void const *output) const;
+
+	// Access for the native backend: the value type of a group, the ranges
+	// [begin, end) of the registers of its owners that are stepped one by
+	// one, and the replacement of their step by generated code.
+	std::type_index GetGroupType(int index) const;
+	std::vector<std::pair<int, int>> GetOwnerRanges(int index) const;
+	void SetNativeStep(int index, NativeStepFunction function, std::shared_ptr<void> const &library);
+};
+
+}
+}
@@ -30,7 +30,18 @@
 #include "messages.h"
 #include "hierarchy.h"
 
-#include "simulator_optimisations.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace dfx {
 
@@ -39,11 +50,194 @@ static int const STATE_PROPAGATING = 1;
 static int const STATE_STEPPING = 2;
 static int const STATE_TERMINATING = 3;
 
-Simulator::Simulator(Design const &design) :
+// Number of polling iterations a thread spends waiting for the next phase
+// (or for the end of the current phase) before it parks on a condition
+// variable. Only used with Synchronisation::SpinThenPark.
+static int const SPIN_LIMIT = 4096;
+
+// Tells the processor that we are in a spin-wait loop. Every now and then
+// the time slice is given up so that spinning does not starve other threads
+// on an oversubscribed machine.
+static inline void CpuRelax(int iteration)
+{
+	if ((iteration & 63) == 63) {
+
+		std::this_thread::yield();
+		return;
+	}
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_pause();
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_ia32_pause();
+#elif defined(__GNUC__) && defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+// Number of blocks the evaluation loop looks ahead when prefetching.
+static int const PREFETCH_DISTANCE = 4;
+
+static inline void Prefetch(void const *address)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_prefetch((char const *)address, _MM_HINT_T0);
+#elif defined(__GNUC__)
+	__builtin_prefetch(address);
+#else
+	(void)address;
+#endif
+}
+
+// Evaluates a contiguous range of a schedule. The block objects are
+// scattered over the heap, so they are fetched a few blocks ahead.
+static inline void EvaluateRange(backend::BlockBase *const *first, backend::BlockBase *const *last)
+{
+	for (auto *const *current = first; current != last; ++current) {
+
+		if (last - current > PREFETCH_DISTANCE)
+			Prefetch(current[PREFETCH_DISTANCE]);
+
+		(*current)->Evaluate();
+	}
+}
+
+// Evaluates the blocks of a schedule one by one and measures their time.
+static void ProfileSchedule(backend::Component &component, int first, int last)
+{
+	for (int i = first; i < last; ++i) {
+
+		auto start = std::chrono::steady_clock::now();
+
+		if (component.program.IsEmpty())
+			component.schedule[i]->Evaluate();
+		else
+			component.program.Execute(i, i + 1);
+
+		auto &profile = component.profile[i];
+		profile.time += std::chrono::steady_clock::now() - start;
+		++profile.calls;
+	}
+}
+
+// Evaluates the pending blocks of a component in schedule order. Blocks whose
+// outputs changed mark the blocks reading them as pending.
+static void EvaluateEvents(backend::Component &component)
+{
+	char *pending = component.pending.data();
+	bool profiling = !component.profile.empty();
+
+	for (int i = 0; i < component.size; ++i) {
+
+		auto *next = static_cast<char *>(std::memchr(pending + i, 1, component.size - i));
+		if (next == nullptr)
+			break;
+
+		i = (int)(next - pending);
+		pending[i] = 0;
+
+		auto *block = component.schedule[i];
+
+		if (profiling) {
+
+			auto start = std::chrono::steady_clock::now();
+			block->Evaluate();
+
+			auto &profile = component.profile[i];
+			profile.time += std::chrono::steady_clock::now() - start;
+			++profile.calls;
+		}
+		else
+			block->Evaluate();
+
+		++component.evaluatedBlocks;
+
+		bool changed = false;
+		for (auto *pin : block->GetOutputPins())
+			changed |= pin->DetectChange();
+
+		if (changed)
+			for (int j = component.fanoutStarts[i]; j < component.fanoutStarts[i + 1]; ++j)
+				pending[component.fanout[j]] = 1;
+	}
+}
+
+// Evaluates the blocks with schedule indices in the range [first, last).
+static inline void EvaluateSchedule(backend::Component &component, int first, int last)
+{
+	if (!component.profile.empty())
+		ProfileSchedule(component, first, last);
+	else if (component.program.IsEmpty())
+		EvaluateRange(component.schedule.data() + first, component.schedule.data() + last);
+	else
+		component.program.Execute(first, last);
+}
+
+Simulator::Options::Options() :
+	mode(Mode::Parallel),
+	engine(Engine::Bytecode),
+	numberOfThreads(0),
+	cores(),
+	synchronisation(Synchronisation::SpinThenPark),
+	taskSize(256),
+	wavefrontThreshold(4096),
+	wavefrontChunkSize(16),
+	dirtyTracking(true),
+	eventDriven(false),
+	lanes(1),
+	packedBooleans(false),
+	calibrateCosts(false),
+	profiling(false),
+	scheduleCacheDirectory(),
+	optimiseExecutionGraph(true),
+	mergeEquivalentBlocks(true),
+	clockEnableGating(true)
+{
+}
+
+Simulator::Simulator(Design const &design, Options const &options /* = Options() */) :
+	options(options),
 	currentComponent(nullptr),
+	valueArena(backend::LaneLayout(options.lanes, options.packedBooleans)),
+	relocatedPins(),
+	designHash(0),
+	scheduleCacheFile(),
+	scheduleFromCache(false),
+	foldedBlocks(),
+	numberOfDeadBlocks(0),
+	mergedBlocks(),
 	runMutex(),
-	runCv()
+	runCv(),
+	runEpoch(0),
+	runPhase(STATE_IDLE),
+	runPending(0),
+	parkedWorkers(0),
+	parkedMain(false),
+	runDoneCv(),
+	asyncThread(),
+	cycleCount(0),
+	runDuration(0),
+	propagateDuration(0)
 {
+	if (this->options.taskSize < 1 || this->options.wavefrontChunkSize < 1)
+		throw design_error("Simulator options 'taskSize' and 'wavefrontChunkSize' must be positive.");
+
+	if (this->options.lanes < 1)
+		throw design_error("Simulator option 'lanes' must be positive.");
+
+	if (this->options.lanes > 1 && this->options.engine != Engine::Bytecode)
+		throw design_error("Simulator option 'lanes' requires 'Engine::Bytecode'.");
+
+	if (this->options.packedBooleans && this->options.engine != Engine::Bytecode)
+		throw design_error("Simulator option 'packedBooleans' requires 'Engine::Bytecode'.");
+
+	if (this->options.eventDriven && (this->options.engine != Engine::Blocks || !this->options.dirtyTracking))
+		throw design_error("Simulator option 'eventDriven' requires 'Engine::Blocks' and 'dirtyTracking'.");
+
+	for (int core : this->options.cores)
+		if (core < 0)
+			throw design_error("Simulator option 'cores' contains the invalid processor index " + std::to_string(core) + ".");
+
 	for (auto &block : design.blocks)
 		block->Simplify();
 
@@ -51,352 +245,2097 @@ Simulator::Simulator(Design const &design) :
 	steppables.reserve(1000);
 	for (auto &block : design.blocks) {
 
+		block->blockIndex = (int)blocks.size();
+		block->excluded = false;
+		blocks.push_back(block.get());
+
 		backend::IStep *steppable = block->GetStep();
-		if (steppable != nullptr)
+		if (steppable != nullptr) {
+
 			steppables.push_back(steppable);
+
+			if (auto *activity = steppable->GetActivity())
+				*activity = backend::StepActivity();
+		}
 	}
 
+	MergeEquivalentBlocks();
+	OptimiseExecutionGraph();
+
 	//
 	// Collect all components of the execution graph and sort them into topological order
 	//
 
-	components.emplace_back();
-	reusableComponents.push_front(&components.back());
-
-	/*
-	// Shuffle the blocks to check the validity of the block sorting algorithms.
-	std::deque<backend::BlockBase *> shuffledBlocks;
-	for (auto &block : design.Blocks)
-		shuffledBlocks.push_back(block.get());
+	if (!this->options.scheduleCacheDirectory.empty()) {
 
-	std::random_device rd;
-	std::mt19937 g(rd());
+		designHash = HashDesign();
+		scheduleCacheFile = (std::filesystem::path(this->options.scheduleCacheDirectory) / string_printf("%016" PRIx64 ".schedule", designHash)).string();
+		scheduleFromCache = LoadSchedule();
+	}
 
-	//std::shuffle(shuffledBlocks.begin(), shuffledBlocks.end(), g);
+	if (!scheduleFromCache) {
 
-	for (auto *block : shuffledBlocks) {
-	*/
+		BuildExecutionOrder(design);
 
-	//int position = 0;
-	for (auto &block : design.blocks) {
+		if (!scheduleCacheFile.empty())
+			SaveSchedule();
+	}
 
-		if (block->CanEvaluate()/* && block->IsConnected()*/) {
+	//
+	// Create background threads
+	//
 
-			if (reusableComponents.empty()) {
+	int numberOfThreads = 1;
 
-#if defined(DFX_SIMULATOR_ENABLE_COMPONENTS) && (DFX_SIMULATOR_ENABLE_COMPONENTS == 1)
+	if (this->options.mode == Mode::Parallel) {
 
-					components.emplace_back();
-					currentComponent = &components.back();
+		numberOfThreads = this->options.numberOfThreads;
+		if (numberOfThreads == 0)
+			numberOfThreads = (int)std::thread::hardware_concurrency() - 1;
+	}
 
-#elif defined(DFX_SIMULATOR_ENABLE_COMPONENTS) && (DFX_SIMULATOR_ENABLE_COMPONENTS == 0)
+	if (numberOfThreads <= 0)
+		numberOfThreads = 1;
 
-#else
+	for (auto &component : components)
+		CompileSchedule(component);
 
-				DFX_SIMULATOR_ENABLE_COMPONENTS must be set to 0 or 1.
+	// Must precede all steps that take the addresses of values.
+	RelocateValues(design);
 
-#endif
-			}
-			else {
+	std::vector<bool> laneBlocks;
+	SetLanes(design, laneBlocks);
 
-				currentComponent = reusableComponents.front();
-				reusableComponents.pop_front();
-			}
+	EvaluateFoldedBlocks(laneBlocks);
 
-			//currentComponent->sortingOrder = position++;
-			RecursiveBuildExecutionOrder(block.get());
-		}
+	EstimateCosts();
 
-	}
+	// Delay blocks move their states into the register bank before the
+	// lowering takes their addresses. With profiling, every block steps
+	// itself to be measured individually.
+	for (int i = 0; i < (int)steppables.size(); ++i)
+		if (this->options.profiling || !steppables[i]->UseRegisterBank(registerBank))
+			steppingIndices.push_back(i);
 
-	components.remove_if([](backend::Component const &component) { return component.blocksFirst == nullptr; });
+	registerBank.Allocate();
 
-	components.sort([](backend::Component const &component1, backend::Component const &component2) { return component1.size / 256 > component2.size / 256; });
+	if (this->options.eventDriven) {
 
-	//
-	// Merge components into tasks of suitable size (does not seem to improve performance much)
-	//
+		for (auto &component : components)
+			BuildFanout(component);
+	}
+	else if (numberOfThreads > 1) {
 
-	int totalComponentCount = std::accumulate(components.begin(), components.end(), 0, [](int current, backend::Component const &component) { return current + component.size; });
-	int minTaskSize = totalComponentCount / 200;
+		// Components that exceed the share of one thread are split along
+		// their topological levels, provided every thread gets a chunk.
+		double totalCost = 0;
+		for (auto const &component : components)
+			totalCost += component.cost;
 
-	tasks.emplace_back();
-	int currentSize = 0;
-	for (auto &component : components) {
+		for (auto &component : components) {
 
-		if (currentSize >= minTaskSize) {
+			bool oversized = component.cost > totalCost / numberOfThreads && component.size >= this->options.wavefrontChunkSize * numberOfThreads;
 
-			currentSize = 0;
-			tasks.emplace_back();
+			if (component.size >= this->options.wavefrontThreshold || oversized)
+				BuildWavefront(component);
 		}
-
-		tasks.back().push_back(&component);
-		currentSize += component.size;
 	}
 
-	//
-	// Create background threads
-	//
+	// Reorders the schedules, which are then lowered.
+	GateComponents();
 
-#if defined(DFX_SIMULATOR_USE_MULTITHREADING) && (DFX_SIMULATOR_USE_MULTITHREADING == 1)
+	if (this->options.engine == Engine::Bytecode) {
 
-	int numberOfThreads = (int)std::thread::hardware_concurrency() - 1;
+		for (auto &component : components)
+			LowerSchedule(component);
 
-#elif defined(DFX_SIMULATOR_USE_MULTITHREADING) && (DFX_SIMULATOR_USE_MULTITHREADING == 0)
+		if (!valueArena.GetLayout().IsTrivial())
+			for (auto const &component : components)
+				CheckLanes(component, laneBlocks);
+	}
 
-	int numberOfThreads = 1;
+	PartitionComponents(numberOfThreads);
 
-#else
+	// The schedules are final at this point.
+	if (this->options.profiling) {
 
-	DFX_SIMULATOR_USE_MULTITHREADING must be set to 0 or 1.
+		for (auto &component : components)
+			for (auto const *block : component.schedule)
+				component.profile.emplace_back(block);
 
-#endif
+		for (auto *block : blocks)
+			if (block->GetStep() != nullptr)
+				stepProfile.emplace_back(block);
+	}
 
-	if (numberOfThreads <= 0)
-		numberOfThreads = 1;
+	auto const &cores = this->options.cores;
 
 	for (int i = 0; i < numberOfThreads - 1; ++i) {
 
 		runStates.push_back(STATE_IDLE);
-		runThreads.push_back(std::thread(&Simulator::RunWorkerThread, this, &runStates.back()));
+		runThreads.push_back(std::thread(&Simulator::RunWorkerThread, this, &runStates.back(), i + 1));
+
+		if (!cores.empty())
+			PinThread(runThreads.back(), cores[i % cores.size()]);
+	}
+}
+
+void Simulator::PinThread(std::thread &thread, int core)
+{
+	bool success = false;
+
+#if defined(_WIN32)
+
+	if (core < 64)
+		success = SetThreadAffinityMask((HANDLE)thread.native_handle(), (DWORD_PTR)1 << core) != 0;
+
+#elif defined(__linux__)
+
+	if (core < CPU_SETSIZE) {
+
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(core, &set);
+		success = pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
 	}
+
+#else
+
+	(void)thread;
+
+#endif
+
+	if (!success)
+		design_info("Could not pin a simulator thread to processor " + std::to_string(core) + ".");
 }
 
 
 
 Simulator::~Simulator()
 {
-	std::unique_lock<std::mutex> lock(runMutex);
+	AwaitAsyncRun();
 
-	std::fill(runStates.begin(), runStates.end(), STATE_TERMINATING);
+	if (options.synchronisation == Synchronisation::SpinThenPark) {
 
-	lock.unlock();
-	runCv.notify_all();
+		std::unique_lock<std::mutex> lock(runMutex);
+
+		runPhase.store(STATE_TERMINATING, std::memory_order_relaxed);
+		runEpoch.fetch_add(1);
+
+		lock.unlock();
+		runCv.notify_all();
+	}
+	else {
+
+		std::unique_lock<std::mutex> lock(runMutex);
+
+		std::fill(runStates.begin(), runStates.end(), STATE_TERMINATING);
+
+		lock.unlock();
+		runCv.notify_all();
+	}
 
 	while (!runThreads.empty()) {
 
 		runThreads.back().join();
 		runThreads.pop_back();
 	}
+
+	// The design may outlive the simulator. The register bank loads the
+	// outputs of the delay lines before the values leave the arena.
+	registerBank.Restore();
+
+	for (auto *pin : relocatedPins)
+		pin->Restore(valueArena);
 }
 
-void Simulator::RecursiveBuildExecutionOrder(backend::BlockBase *current)
+// Blocks are visited in creation order, so that the inputs of most blocks are
+// final by the time they are compared. A duplicate passes the inputs it
+// drives on to the first equivalent block and is not scheduled. Merging may
+// turn the readers into duplicates as well. Feedback through forward nodes
+// can make these precede the merged block, in which case another pass finds
+// them.
+void Simulator::MergeEquivalentBlocks()
 {
-	if (!current->CanEvaluate())
+	if (!options.mergeEquivalentBlocks)
 		return;
 
-	if (current->mark) {
+	std::unordered_map<std::size_t, std::vector<backend::BlockBase *>> candidates;
+	bool merged = true;
 
-		design_info("A computational cycle was detected involving block '" + current->GetFullName() + "'.");
-		throw design_error("The design contains at least one computational cycle. This means that an output of a block eventually leads to an input of the same block without at least one delay element in the path.");
-	}
+	while (merged) {
+
+		merged = false;
+		candidates.clear();
 
-	if (current->component) {
+		for (auto *block : blocks) {
 
-		if (current->component != currentComponent) {
+			if (block->excluded || block->GetStep() != nullptr || block->IsObservable() || block->GetHierarchyLevel()->KeepsDuplicates())
+				continue;
 
-			backend::Component *toComponent = current->component;
-			backend::Component *fromComponent = currentComponent;
+			auto const &outputs = block->GetOutputPins();
 
-			// Making sure that the smaller list becomes mergerd into the larger one 
-			// gives a significant performance improvement.
-			// TODO: are we really free to swap the order in which the two lists are merged?
-			if (fromComponent->size > toComponent->size)
-				std::swap(toComponent, fromComponent);
+			if (std::none_of(outputs.begin(), outputs.end(), [](backend::OutputPinBase const *output) { return output->IsConnected(); }))
+				continue;
 
-			if (fromComponent->size > 0) {
+			auto &list = candidates[block->GetHash()];
 
-				for (auto *block = fromComponent->blocksFirst; block != nullptr; block = block->componentNext)
-					block->component = toComponent;
+			auto equivalent = std::find_if(list.begin(), list.end(), [block](backend::BlockBase const *candidate) {
 
-				toComponent->size += fromComponent->size;
+				if (typeid(*candidate) != typeid(*block) || candidate->GetOutputPins().size() != block->GetOutputPins().size())
+					return false;
 
-				// concatenation order based on sortingOrder does not yield the expected speed improvement. Keep it here for reference.
-				//if (toComponent->sortingOrder < fromComponent->sortingOrder) {
+				for (std::size_t i = 0; i < block->GetOutputPins().size(); ++i)
+					if (candidate->GetOutputPins()[i]->GetType() != block->GetOutputPins()[i]->GetType())
+						return false;
 
-					*toComponent->blocksEnd = fromComponent->blocksFirst;
-					toComponent->blocksEnd = fromComponent->blocksEnd;
-				/*}
-				else {
+				auto const &inputs = block->GetInputPins();
+				auto const &candidateInputs = candidate->GetInputPins();
 
-					*fromComponent->blocksEnd = toComponent->blocksFirst;
-					fromComponent->blocksEnd = toComponent->blocksEnd;
+				if (!std::equal(inputs.begin(), inputs.end(), candidateInputs.begin(), candidateInputs.end(), [](backend::InputPinBase const *lhs, backend::InputPinBase const *rhs) { return lhs->GetDrivingPin() == rhs->GetDrivingPin(); }))
+					return false;
 
-					toComponent->sortingOrder = fromComponent->sortingOrder;
-					toComponent->blocksFirst = fromComponent->blocksFirst;
-					toComponent->blocksEnd = fromComponent->blocksEnd;
-				}*/
+				return block->IsEquivalent(*candidate);
+			});
+
+			if (equivalent == list.end()) {
+
+				list.push_back(block);
+				continue;
 			}
 
-			fromComponent->size = 0;
-			fromComponent->blocksFirst = nullptr;
-			fromComponent->blocksEnd = &fromComponent->blocksFirst;
-			reusableComponents.push_front(fromComponent);
+			for (std::size_t i = 0; i < outputs.size(); ++i)
+				outputs[i]->MoveDrivenPins(*(*equivalent)->GetOutputPins()[i]);
 
-			currentComponent = toComponent;
+			block->excluded = true;
+			mergedBlocks[block] = *equivalent;
+			merged = true;
 		}
-
-		return;
 	}
+}
 
-	current->mark = true;
+// Blocks that are not scheduled keep their outputs during the simulation.
+// The outputs of a block are therefore constant if all its inputs are driven
+// by such blocks or by blocks that are constant themselves. The blocks are
+// visited depth-first with an explicit stack, and blocks with constant
+// inputs are appended to 'foldedBlocks' once all their sources are known.
+void Simulator::OptimiseExecutionGraph()
+{
+	if (!options.optimiseExecutionGraph)
+		return;
 
-	// https://en.wikipedia.org/wiki/Topological_sorting
-	for (auto *block : current->GetSourceBlocks())
-		RecursiveBuildExecutionOrder(block);
+	// Mark all blocks from which a clocked or observable block can be reached.
+	std::vector<bool> live(blocks.size(), false);
+	std::vector<backend::BlockBase *> pending;
 
-	current->mark = false;
-	current->component = currentComponent;
+	for (auto *block : blocks) {
 
-	++currentComponent->size;
-	*currentComponent->blocksEnd = current;
-	currentComponent->blocksEnd = &current->componentNext;
-}
+		if (block->GetStep() != nullptr || block->IsObservable()) {
 
-void Simulator::PropagateCore()
-{
-	int index = currentTaskIndex.fetch_add(1, std::memory_order_relaxed);
+			live[block->blockIndex] = true;
+			pending.push_back(block);
+		}
+	}
 
-	while (index < (int)tasks.size()) {
+	while (!pending.empty()) {
 
-		auto const &task = tasks[index];
+		auto *block = pending.back();
+		pending.pop_back();
 
-		for (auto *component : task) {
+		for (auto const *input : block->GetInputPins()) {
 
-			if (component->outdated) {
+			auto *source = input->GetDrivingBlock();
 
-				component->outdated = false;
+			if (source && !live[source->blockIndex]) {
 
-				for (auto *block = component->blocksFirst; block != nullptr; block = block->componentNext)
-					block->Evaluate();
+				live[source->blockIndex] = true;
+				pending.push_back(source);
 			}
 		}
-
-		index = currentTaskIndex.fetch_add(1, std::memory_order_relaxed);
 	}
-}
 
-void Simulator::RunWorkerThread(int *state)
-{
-	std::unique_lock<std::mutex> lock(runMutex);
+	for (auto *block : blocks) {
 
-	while (*state != STATE_TERMINATING) {
+		if (block->CanEvaluate() && !block->excluded && !live[block->blockIndex]) {
 
-		runCv.wait(lock, [state] { return *state != STATE_IDLE; });
-		lock.unlock();
+			block->excluded = true;
+			++numberOfDeadBlocks;
+		}
+	}
 
-		switch (*state) {
+	// Classify the live blocks. Blocks within a cycle are never constant, the
+	// cycle is reported by the sorting.
+	enum { UNKNOWN, VISITING, CONSTANT, VARIABLE };
+	std::vector<char> states(blocks.size(), UNKNOWN);
+	std::vector<std::pair<backend::BlockBase *, bool>> stack;
 
-			case STATE_TERMINATING:
-				return;
+	for (auto *root : blocks) {
 
-			case STATE_PROPAGATING:
-				PropagateCore();
-				break;
+		if (!live[root->blockIndex] || states[root->blockIndex] != UNKNOWN)
+			continue;
 
-			case STATE_STEPPING:
-				StepCore();
-				break;
-		}
+		stack.emplace_back(root, false);
 
-		lock.lock();
-		*state = STATE_IDLE;
-		runCv.notify_all();
-	}
-}
+		while (!stack.empty()) {
 
-void Simulator::Propagate()
-{
-	std::unique_lock<std::mutex> lock(runMutex);
+			auto *block = stack.back().first;
+			bool visited = stack.back().second;
+			stack.pop_back();
 
-	currentTaskIndex = 0;
-	std::fill(runStates.begin(), runStates.end(), STATE_PROPAGATING);
-	runCv.notify_all();
-	lock.unlock();
+			auto &state = states[block->blockIndex];
+			auto const &inputs = block->GetInputPins();
 
-	PropagateCore();
+			if (!visited) {
 
-	lock.lock();
-	runCv.wait(lock, [this] { 
-		return std::all_of(runStates.cbegin(), runStates.cend(), [](int state) { return state == STATE_IDLE; });
-	});
-}
+				if (state != UNKNOWN)
+					continue;
 
-void Simulator::StepCore()
-{
-	int index = currentSteppableIndex.fetch_add(1, std::memory_order_relaxed);
+				if (!block->CanEvaluate()) {
 
-	while (index < (int)steppables.size()) {
+					state = block->GetStep() == nullptr ? CONSTANT : VARIABLE;
+					continue;
+				}
 
-		steppables[index]->Step();
-		index = currentSteppableIndex.fetch_add(1, std::memory_order_relaxed);
-	}
-}
+				if (block->GetStep() != nullptr || inputs.empty()) {
 
-	
+					state = VARIABLE;
+					continue;
+				}
 
-void Simulator::Step()
-{
-	std::unique_lock<std::mutex> lock(runMutex);
+				state = VISITING;
+				stack.emplace_back(block, true);
 
-	currentSteppableIndex = 0;
-	std::fill(runStates.begin(), runStates.end(), STATE_STEPPING);
-	runCv.notify_all();
-	lock.unlock();
+				for (auto const *input : inputs) {
 
-	StepCore();
+					auto *source = input->GetDrivingBlock();
 
-	lock.lock();
-	runCv.wait(lock, [this] {
-		return std::all_of(runStates.cbegin(), runStates.cend(), [](int state) { return state == STATE_IDLE; });
-	});
-}
+					if (source && states[source->blockIndex] == UNKNOWN)
+						stack.emplace_back(source, false);
+				}
+			}
+			else {
 
-void Simulator::Run(unsigned numberOfIterations /* = 1 */)
-{
-	Propagate();
+				bool constant = std::all_of(inputs.begin(), inputs.end(), [&states](backend::InputPinBase const *input) {
 
-	while (numberOfIterations-- > 0) {
+					auto *source = input->GetDrivingBlock();
+					return source && states[source->blockIndex] == CONSTANT;
+				});
 
-		Step();
-		Propagate();
+				state = constant ? CONSTANT : VARIABLE;
+
+				if (constant) {
+
+					block->excluded = true;
+					foldedBlocks.push_back(block);
+				}
+			}
+		}
 	}
 }
 
-void Simulator::AsyncReset()
+// Evaluates the blocks with constant inputs in the same way as a component.
+void Simulator::EvaluateFoldedBlocks(std::vector<bool> const &laneBlocks)
 {
-	for (auto *steppable : steppables)
-		steppable->AsyncReset();
+	if (foldedBlocks.empty())
+		return;
 
-	Propagate();
+	backend::Component component;
+	component.schedule = foldedBlocks;
+	component.size = (int)foldedBlocks.size();
+
+	if (options.engine == Engine::Bytecode) {
+
+		LowerSchedule(component);
+
+		if (!valueArena.GetLayout().IsTrivial())
+			CheckLanes(component, laneBlocks);
+	}
+
+	EvaluateSchedule(component, 0, component.size);
 }
 
-void Simulator::Report(std::basic_ostream<char> &os) const
+void Simulator::BuildExecutionOrder(Design const &design)
 {
-	using std::endl;
-	using std::setw;
+	components.emplace_back();
+	reusableComponents.push_front(&components.back());
 
-	std::map<int, int> componentSizes;
-	for (auto const &component : components)
-		componentSizes[(int)std::ceil(std::log2(component.size))]++;
+	/*
+	// Shuffle the blocks to check the validity of the block sorting algorithms.
+	std::deque<backend::BlockBase *> shuffledBlocks;
+	for (auto &block : design.Blocks)
+		shuffledBlocks.push_back(block.get());
 
-	os << " --- Simulator --- " << endl << endl;
+	std::random_device rd;
+	std::mt19937 g(rd());
 
-	os << " Number of components        : " << components.size() << endl;
-	os << " Number of computable blocks : " << std::accumulate(components.begin(), components.end(), 0, [](int current, backend::Component const &component) { return current + component.size; }) << endl;
-	os << " Number of steppable blocks  : " << steppables.size() << endl;
-	os << " Number of tasks             : " << tasks.size() << endl;
-	os << " Number of parallel threads  : " << runThreads.size() + 1 << endl;
+	//std::shuffle(shuffledBlocks.begin(), shuffledBlocks.end(), g);
 
-	os << endl;
-	os << " Components by size" << endl;
-	os << endl;
+	for (auto *block : shuffledBlocks) {
+	*/
 
-	for (auto const &x : componentSizes)
-		os << setw(10) << (1 << x.first) << " : " << x.second << endl;
+	std::vector<std::pair<backend::BlockBase *, std::size_t>> path;
+	std::vector<backend::BlockBase *> pending;
+
+	//int position = 0;
+	for (auto &block : design.blocks) {
+
+		if (block->CanEvaluate() && !block->excluded/* && block->IsConnected()*/) {
+
+			if (reusableComponents.empty()) {
+
+				components.emplace_back();
+				currentComponent = &components.back();
+			}
+			else {
+
+				currentComponent = reusableComponents.front();
+				reusableComponents.pop_front();
+			}
+
+			//currentComponent->sortingOrder = position++;
+			AddToExecutionOrder(block.get(), path, pending);
+		}
+
+	}
+
+	components.remove_if([](backend::Component const &component) { return component.blocksFirst == nullptr; });
+}
+
+// The hash covers the class, the connections and CanEvaluate() of all blocks
+// in creation order, which together determine the schedule, and whether the
+// execution graph is optimised.
+std::uint64_t Simulator::HashDesign() const
+{
+	std::size_t hash = 0;
+	hash_combine(hash, blocks.size());
+	hash_combine(hash, options.optimiseExecutionGraph);
+
+	for (auto *block : blocks) {
+
+		hash_combine(hash, block->GetClassName());
+		hash_combine(hash, block->CanEvaluate());
+		hash_combine(hash, block->GetInputPins().size());
+		hash_combine(hash, block->GetOutputPins().size());
+
+		for (auto const *input : block->GetInputPins()) {
+
+			auto const *driver = input->GetDrivingPin();
+
+			if (driver) {
+
+				hash_combine(hash, driver->GetOwner()->blockIndex);
+				hash_combine(hash, driver->GetIndex());
+			}
+			else
+				hash_combine(hash, -1);
+		}
+	}
+
+	return hash;
+}
+
+static char const scheduleMagic[8] = { 'O', 'D', 'D', 'F', 'S', 'C', 'H', 'D' };
+static std::uint32_t const scheduleVersion = 1;
+
+// Components are stored as the creation indices of their blocks in
+// evaluation order.
+void Simulator::SaveSchedule() const
+{
+	std::vector<char> data;
+	backend::StateWriter writer(data);
+
+	writer.WriteBytes(scheduleMagic, sizeof(scheduleMagic));
+	writer.Write(scheduleVersion);
+	writer.Write(designHash);
+	writer.Write((std::uint64_t)blocks.size());
+	writer.Write((std::uint64_t)components.size());
+
+	std::vector<int> members;
+
+	for (auto const &component : components) {
+
+		members.clear();
+
+		for (auto *block = component.blocksFirst; block != nullptr; block = block->componentNext)
+			members.push_back(block->blockIndex);
+
+		writer.Write(members);
+	}
+
+	// Several simulators may fill the cache at the same time. The file is
+	// therefore written under a temporary name and renamed when complete.
+	std::error_code error;
+	std::filesystem::create_directories(options.scheduleCacheDirectory, error);
+
+	std::string temporaryFile = scheduleCacheFile + "." + std::to_string(std::random_device()()) + ".tmp";
+
+	{
+		std::ofstream file(temporaryFile, std::ios::binary);
+		file.write(data.data(), data.size());
+
+		if (!file) {
+
+			design_info("Could not write the schedule cache file '" + scheduleCacheFile + "'.");
+			return;
+		}
+	}
+
+	std::filesystem::rename(temporaryFile, scheduleCacheFile, error);
+
+	if (error) {
+
+		std::filesystem::remove(temporaryFile, error);
+		design_info("Could not write the schedule cache file '" + scheduleCacheFile + "'.");
+	}
+}
+
+// Returns 'false' if there is no valid schedule for the design in the cache,
+// in which case the schedule must be built. A damaged file or a hash
+// collision is not an error, the file is then replaced.
+bool Simulator::LoadSchedule()
+{
+	std::ifstream file(scheduleCacheFile, std::ios::binary);
+
+	if (!file)
+		return false;
+
+	std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	backend::StateReader reader(data);
+
+	char magic[sizeof(scheduleMagic)];
+	std::uint32_t version;
+	std::uint64_t hash, numberOfBlocks, numberOfComponents;
+
+	if (reader.GetRemainingSize() < sizeof(magic) + sizeof(version) + 3 * sizeof(std::uint64_t))
+		return false;
+
+	reader.ReadBytes(magic, sizeof(magic));
+	reader.Read(version);
+	reader.Read(hash);
+	reader.Read(numberOfBlocks);
+	reader.Read(numberOfComponents);
+
+	if (std::memcmp(magic, scheduleMagic, sizeof(magic)) != 0 || version != scheduleVersion || hash != designHash || numberOfBlocks != blocks.size())
+		return false;
+
+	std::vector<int> members;
+	std::size_t numberOfScheduledBlocks = 0;
+	bool valid = true;
+
+	for (std::uint64_t i = 0; valid && i < numberOfComponents; ++i) {
+
+		std::uint64_t size = 0;
+
+		if (reader.GetRemainingSize() >= sizeof(size))
+			reader.Read(size);
+
+		if (size == 0 || size > reader.GetRemainingSize() / sizeof(int)) {
+
+			valid = false;
+			break;
+		}
+
+		members.resize((std::size_t)size);
+		reader.Read(members.data(), members.size());
+
+		components.emplace_back();
+		auto &component = components.back();
+
+		for (int index : members) {
+
+			if (index < 0 || index >= (int)blocks.size() || blocks[index]->component != nullptr || !blocks[index]->CanEvaluate() || blocks[index]->excluded) {
+
+				valid = false;
+				break;
+			}
+
+			auto *block = blocks[index];
+			block->component = &component;
+
+			*component.blocksEnd = block;
+			component.blocksEnd = &block->componentNext;
+			++component.size;
+		}
+
+		*component.blocksEnd = nullptr;
+		numberOfScheduledBlocks += members.size();
+	}
+
+	valid = valid && reader.IsAtEnd() && numberOfScheduledBlocks == (std::size_t)std::count_if(blocks.begin(), blocks.end(), [](backend::BlockBase const *block) { return block->CanEvaluate() && !block->excluded; });
+
+	if (!valid) {
+
+		for (auto *block : blocks) {
+
+			block->component = nullptr;
+			block->componentNext = nullptr;
+		}
+
+		components.clear();
+	}
+
+	return valid;
+}
+
+// Joins the current component with the given one, which a block of the
+// current component depends on.
+void Simulator::MergeComponent(backend::Component *component)
+{
+	backend::Component *toComponent = component;
+	backend::Component *fromComponent = currentComponent;
+
+	// Making sure that the smaller list becomes mergerd into the larger one 
+	// gives a significant performance improvement.
+	// TODO: are we really free to swap the order in which the two lists are merged?
+	if (fromComponent->size > toComponent->size)
+		std::swap(toComponent, fromComponent);
+
+	if (fromComponent->size > 0) {
+
+		for (auto *block = fromComponent->blocksFirst; block != nullptr; block = block->componentNext)
+			block->component = toComponent;
+
+		toComponent->size += fromComponent->size;
+
+		// concatenation order based on sortingOrder does not yield the expected speed improvement. Keep it here for reference.
+		//if (toComponent->sortingOrder < fromComponent->sortingOrder) {
+
+			*toComponent->blocksEnd = fromComponent->blocksFirst;
+			toComponent->blocksEnd = fromComponent->blocksEnd;
+		/*}
+		else {
+
+			*fromComponent->blocksEnd = toComponent->blocksFirst;
+			fromComponent->blocksEnd = toComponent->blocksEnd;
+
+			toComponent->sortingOrder = fromComponent->sortingOrder;
+			toComponent->blocksFirst = fromComponent->blocksFirst;
+			toComponent->blocksEnd = fromComponent->blocksEnd;
+		}*/
+	}
+
+	fromComponent->size = 0;
+	fromComponent->blocksFirst = nullptr;
+	fromComponent->blocksEnd = &fromComponent->blocksFirst;
+	reusableComponents.push_front(fromComponent);
+
+	currentComponent = toComponent;
+}
+
+// Depth-first search with an explicit stack, so that the depth of the design
+// is not limited by the stack size (https://en.wikipedia.org/wiki/Topological_sorting).
+// 'path' holds the blocks being visited, each with the size of 'pending' at
+// the time it was entered. 'pending' holds the source blocks still to be
+// visited, in reverse order, so that they are visited in the order given by
+// ForEachSourceBlock(). A block is complete once 'pending' is back at its size.
+void Simulator::AddToExecutionOrder(backend::BlockBase *root, std::vector<std::pair<backend::BlockBase *, std::size_t>> &path, std::vector<backend::BlockBase *> &pending)
+{
+	pending.assign(1, root);
+
+	while (!pending.empty() || !path.empty()) {
+
+		if (!path.empty() && pending.size() == path.back().second) {
+
+			auto *current = path.back().first;
+			path.pop_back();
+
+			current->mark = false;
+			current->component = currentComponent;
+
+			++currentComponent->size;
+			*currentComponent->blocksEnd = current;
+			currentComponent->blocksEnd = &current->componentNext;
+			continue;
+		}
+
+		auto *current = pending.back();
+		pending.pop_back();
+
+		if (!current->CanEvaluate() || current->excluded)
+			continue;
+
+		if (current->mark) {
+
+			design_info("A computational cycle was detected involving block '" + current->GetFullName() + "'.");
+
+			std::string cycle;
+			auto first = std::find_if(path.begin(), path.end(), [current](std::pair<backend::BlockBase *, std::size_t> const &entry) { return entry.first == current; });
+
+			for (auto it = first; it != path.end(); ++it)
+				cycle += (it == first ? "'" : " <- '") + it->first->GetFullName() + "'";
+
+			design_info("The cycle consists of the blocks " + cycle + ", each driven by the next and the last by the first.");
+			throw design_error("The design contains at least one computational cycle. This means that an output of a block eventually leads to an input of the same block without at least one delay element in the path.");
+		}
+
+		if (current->component) {
+
+			if (current->component != currentComponent)
+				MergeComponent(current->component);
+
+			continue;
+		}
+
+		current->mark = true;
+		path.emplace_back(current, pending.size());
+
+		auto first = pending.size();
+		current->ForEachSourceBlock([&pending](backend::BlockBase *source) { pending.push_back(source); });
+		std::reverse(pending.begin() + first, pending.end());
+	}
+}
+
+void Simulator::CompileSchedule(backend::Component &component)
+{
+	component.schedule.clear();
+	component.schedule.reserve(component.size);
+
+	for (auto *block = component.blocksFirst; block != nullptr; block = block->componentNext)
+		component.schedule.push_back(block);
+}
+
+void Simulator::RelocateValues(Design const &design)
+{
+	// Values are laid out in evaluation order. Pins of blocks outside the
+	// schedule, such as constants, follow at the end.
+	for (auto const &component : components)
+		for (auto *block : component.schedule)
+			relocatedPins.insert(relocatedPins.end(), block->GetOutputPins().begin(), block->GetOutputPins().end());
+
+	for (auto const &block : design.blocks)
+		if (block->component == nullptr)
+			relocatedPins.insert(relocatedPins.end(), block->GetOutputPins().begin(), block->GetOutputPins().end());
+
+	for (auto *pin : relocatedPins)
+		pin->Reserve(valueArena);
+
+	for (auto *pin : relocatedPins)
+		pin->Relocate(valueArena);
+}
+
+// Lets all blocks prepare for the lane layout of the arena and collects those
+// that handle it themselves. Clocked blocks must do so. Blocks are always
+// informed, since they may still be set up for a previous simulator.
+void Simulator::SetLanes(Design const &design, std::vector<bool> &laneBlocks)
+{
+	auto const &layout = valueArena.GetLayout();
+
+	laneBlocks.assign(blocks.size(), false);
+
+	for (auto const &block : design.blocks) {
+
+		if (block->SetLanes(layout))
+			laneBlocks[block->blockIndex] = true;
+		else if (!layout.IsTrivial() && block->GetStep() != nullptr)
+			throw design_error("Block '" + block->GetFullName() + "' of class '" + block->GetClassName() + "' does not support simulation with several lanes.");
+	}
+}
+
+// All other evaluated blocks must have been lowered to lane-aware kernels.
+void Simulator::CheckLanes(backend::Component const &component, std::vector<bool> const &laneBlocks) const
+{
+	for (int i = 0; i < (int)component.schedule.size(); ++i) {
+
+		auto const *block = component.schedule[i];
+
+		if (component.program.CallsEvaluate(i) && !laneBlocks[block->blockIndex])
+			throw design_error("Block '" + block->GetFullName() + "' of class '" + block->GetClassName() + "' does not support simulation with several lanes.");
+	}
+}
+
+void Simulator::EstimateCosts()
+{
+	if (options.calibrateCosts)
+		costModel.Calibrate(blocks);
+
+	for (auto &component : components) {
+
+		component.cost = 0;
+
+		for (auto const *block : component.schedule)
+			component.cost += costModel.GetCost(block);
+	}
+}
+
+void Simulator::LowerSchedule(backend::Component &component)
+{
+	backend::ProgramBuilder builder(component.program, valueArena.GetLayout());
+
+	for (auto *block : component.schedule)
+		builder.Add(block);
+
+	builder.Finish();
+}
+
+void Simulator::BuildWavefront(backend::Component &component)
+{
+	// The blocks of a component are linked in topological order. Therefore,
+	// the levels of all sources within the component are known by the time a
+	// block is visited.
+	int numberOfLevels = 0;
+
+	for (auto *block : component.schedule) {
+
+		block->level = 0;
+
+		block->ForEachSourceBlock([block, &component](backend::BlockBase *source) {
+
+			if (source->component == &component)
+				block->level = std::max(block->level, source->level + 1);
+		});
+
+		numberOfLevels = std::max(numberOfLevels, block->level + 1);
+	}
+
+	// Narrow components, e.g. long chains, do not benefit from the parallel
+	// evaluation but would pay for the synchronisation between the levels.
+	if (component.size < 2 * numberOfLevels)
+		return;
+
+	std::vector<int> levelStarts(numberOfLevels + 1, 0);
+	for (auto *block : component.schedule)
+		++levelStarts[block->level + 1];
+
+	std::partial_sum(levelStarts.begin(), levelStarts.end(), levelStarts.begin());
+
+	component.wavefrontLevels = levelStarts;
+
+	for (auto *block = component.blocksFirst; block != nullptr; block = block->componentNext)
+		component.schedule[levelStarts[block->level]++] = block;
+
+	wavefrontComponents.push_back(&component);
+}
+
+void Simulator::EvaluateWavefront(backend::Component &component)
+{
+	auto const &levelStarts = component.wavefrontLevels;
+
+	int size = (int)component.schedule.size();
+	int level = 0;
+
+	for (;;) {
+
+		int first = component.wavefrontCursor.fetch_add(options.wavefrontChunkSize, std::memory_order_relaxed);
+		if (first >= size)
+			return;
+
+		int last = std::min(first + options.wavefrontChunkSize, size);
+
+		// A chunk may span several levels. Before a level can be evaluated, all
+		// blocks of the previous levels must be done. Blocks are claimed in
+		// increasing order, so a single counter of finished blocks suffices.
+		while (first < last) {
+
+			while (levelStarts[level + 1] <= first)
+				++level;
+
+			for (int i = 0; component.wavefrontDone.load(std::memory_order_acquire) < levelStarts[level]; ++i)
+				CpuRelax(i);
+
+			int end = std::min(last, levelStarts[level + 1]);
+
+			EvaluateSchedule(component, first, end);
+
+			component.wavefrontDone.fetch_add(end - first, std::memory_order_release);
+			first = end;
+		}
+	}
+}
+
+void Simulator::BuildFanout(backend::Component &component)
+{
+	int size = component.size;
+
+	for (int i = 0; i < size; ++i)
+		component.schedule[i]->scheduleIndex = i;
+
+	// Blocks outside the component, such as constants, never change.
+	std::vector<std::vector<int>> readers(size);
+
+	for (int i = 0; i < size; ++i) {
+
+		component.schedule[i]->ForEachSourceBlock([i, &component, &readers](backend::BlockBase *source) {
+
+			if (source->component == &component)
+				readers[source->scheduleIndex].push_back(i);
+		});
+	}
+
+	component.fanoutStarts.assign(1, 0);
+	component.fanout.clear();
+
+	for (auto &list : readers) {
+
+		// A block reading several pins of the same source is listed once.
+		std::sort(list.begin(), list.end());
+		list.erase(std::unique(list.begin(), list.end()), list.end());
+		component.fanout.insert(component.fanout.end(), list.begin(), list.end());
+		component.fanoutStarts.push_back((int)component.fanout.size());
+	}
+
+	// The first evaluation covers all blocks.
+	component.pending.assign(size, 1);
+}
+
+// Finds the blocks that need not be evaluated while the enable of the
+// clocked blocks they lead to is low. A block is gated if every block
+// reading its outputs is a gated block of the same component, a clocked
+// block with the same enable or a block that does not use its inputs during
+// the simulation, such as a label. Gated blocks only lead to gated blocks
+// with the same enable, so moving them to the end of the schedule keeps the
+// evaluation order intact.
+void Simulator::GateComponents()
+{
+	if (!options.clockEnableGating || options.eventDriven || !valueArena.GetLayout().IsTrivial())
+		return;
+
+	double maximumLeadingCost = options.taskSize * backend::CostModel::defaultCost;
+
+	// The common enable of the readers of every block seen so far, and
+	// whether a reader rules out gating.
+	std::vector<backend::InputPin<bool> const *> enables(blocks.size(), nullptr);
+	std::vector<bool> ungated(blocks.size(), false);
+
+	auto restrict = [&](backend::BlockBase const *block, backend::InputPin<bool> const *enable) {
+
+		int index = block->blockIndex;
+
+		// An enable computed by another component can only be used if that
+		// component is cheap enough to be evaluated first.
+		auto const *source = enable != nullptr ? enable->GetDrivingBlock() : nullptr;
+		auto const *leading = source != nullptr ? source->component : nullptr;
+
+		bool usable = source != nullptr && (leading == nullptr || leading == block->component || (leading->cost <= maximumLeadingCost && leading->wavefrontLevels.empty()));
+
+		if (!usable || (enables[index] != nullptr && enables[index]->GetDrivingPin() != enable->GetDrivingPin()))
+			ungated[index] = true;
+		else
+			enables[index] = enable;
+	};
+
+	// Readers that are not evaluated together with the driving block
+	for (auto *reader : blocks) {
+
+		if (reader->excluded)
+			continue;
+
+		auto *step = reader->GetStep();
+		auto const *enableInput = step != nullptr ? step->GetEnableInput() : nullptr;
+
+		for (auto const *input : reader->GetInputPins()) {
+
+			auto *driver = input->GetDrivingBlock();
+
+			if (driver == nullptr || driver->component == nullptr || (reader->component == driver->component && reader->IsSourcePin(*input)))
+				continue;
+
+			if (reader->IsObservable() || (step == nullptr && reader->CanEvaluate()))
+				restrict(driver, nullptr);
+			else if (step != nullptr)
+				restrict(driver, input != enableInput ? enableInput : nullptr);
+		}
+	}
+
+	// Readers within the component, which follow the driving block in the
+	// schedule and are therefore complete when visited in reverse order.
+	for (auto &component : components) {
+
+		for (auto it = component.schedule.rbegin(); it != component.schedule.rend(); ++it) {
+
+			auto *block = *it;
+			int index = block->blockIndex;
+
+			if (enables[index] == nullptr || block->IsObservable() || !component.wavefrontLevels.empty())
+				ungated[index] = true;
+
+			for (auto const *input : block->GetInputPins())
+				if (block->IsSourcePin(*input) && input->GetDrivingBlock() != nullptr)
+					restrict(input->GetDrivingBlock(), ungated[index] ? nullptr : enables[index]);
+		}
+	}
+
+	for (auto &component : components) {
+
+		for (auto *block : component.schedule) {
+
+			int index = block->blockIndex;
+			auto *leading = ungated[index] ? nullptr : enables[index]->GetDrivingBlock()->component;
+
+			if (leading != nullptr && leading != &component && !leading->leading) {
+
+				leading->leading = true;
+				leadingComponents.push_back(leading);
+			}
+		}
+	}
+
+	// The leading components are evaluated one after the other and do not
+	// wait for each other's enables, so they are not gated themselves.
+	for (auto &component : components) {
+
+		if (component.leading || !component.wavefrontLevels.empty())
+			continue;
+
+		std::vector<backend::BlockBase *> schedule;
+		std::vector<std::vector<backend::BlockBase *>> gatedBlocks;
+		std::vector<bool const *> gateEnables;
+
+		schedule.reserve(component.schedule.size());
+
+		for (auto *block : component.schedule) {
+
+			int index = block->blockIndex;
+
+			if (ungated[index]) {
+
+				schedule.push_back(block);
+				continue;
+			}
+
+			bool const *enable = &enables[index]->GetValue();
+			auto gate = std::find(gateEnables.begin(), gateEnables.end(), enable) - gateEnables.begin();
+
+			if (gate == (std::ptrdiff_t)gateEnables.size()) {
+
+				gateEnables.push_back(enable);
+				gatedBlocks.emplace_back();
+			}
+
+			gatedBlocks[gate].push_back(block);
+		}
+
+		for (std::size_t i = 0; i < gateEnables.size(); ++i) {
+
+			component.gates.emplace_back(gateEnables[i], (int)schedule.size());
+			schedule.insert(schedule.end(), gatedBlocks[i].begin(), gatedBlocks[i].end());
+			component.gates.back().last = (int)schedule.size();
+		}
+
+		component.schedule = std::move(schedule);
+
+		for (int i = 0; i < component.size; ++i)
+			component.schedule[i]->scheduleIndex = i;
+	}
+}
+
+void Simulator::PartitionComponents(int numberOfThreads)
+{
+	// Seed the work queues by a cost-balanced partitioning: the components
+	// are handed out most expensive first, each one to the queue with the
+	// lowest estimated cost so far. Within a queue, large components therefore
+	// come first and the small ones at the back are the ones that become
+	// stolen. Consecutive components are combined into tasks of at least
+	// 'taskSize' simple blocks. Wavefront components are shared by all threads.
+	std::vector<backend::Component *> sortedComponents;
+	sortedComponents.reserve(components.size());
+	for (auto &component : components)
+		if (component.wavefrontLevels.empty() && !component.leading)
+			sortedComponents.push_back(&component);
+
+	std::stable_sort(sortedComponents.begin(), sortedComponents.end(), [](backend::Component const *component1, backend::Component const *component2) {
+		return component1->cost > component2->cost;
+	});
+
+	workQueues = std::vector<backend::WorkQueue>(numberOfThreads);
+
+	for (auto *component : wavefrontComponents) {
+
+		for (auto &queue : workQueues) {
+
+			queue.plannedSize += component->size / numberOfThreads;
+			queue.plannedCost += component->cost / numberOfThreads;
+		}
+	}
+
+	for (auto *component : sortedComponents) {
+
+		auto &queue = *std::min_element(workQueues.begin(), workQueues.end(), [](backend::WorkQueue const &queue1, backend::WorkQueue const &queue2) {
+			return queue1.plannedCost < queue2.plannedCost;
+		});
+
+		queue.components.push_back(component);
+		queue.plannedSize += component->size;
+		queue.plannedCost += component->cost;
+	}
+
+	double minimumTaskCost = options.taskSize * backend::CostModel::defaultCost;
+
+	for (auto &queue : workQueues) {
+
+		double taskCost = 0;
+
+		for (int i = 0; i < (int)queue.components.size(); ++i) {
+
+			taskCost += queue.components[i]->cost;
+
+			if (taskCost >= minimumTaskCost || i + 1 == (int)queue.components.size()) {
+
+				queue.taskStarts.push_back(i + 1);
+				taskCost = 0;
+			}
+		}
+	}
+}
+
+void Simulator::ResetWorkQueues()
+{
+	for (auto &queue : workQueues)
+		queue.Reset();
+
+	// All threads walk the same list of outdated wavefront components. The
+	// flags are therefore evaluated and cleared here, before the threads start.
+	outdatedWavefronts.clear();
+
+	for (auto *component : wavefrontComponents) {
+
+		if (component->outdated || !options.dirtyTracking) {
+
+			component->outdated = false;
+			component->wavefrontCursor.store(0, std::memory_order_relaxed);
+			component->wavefrontDone.store(0, std::memory_order_relaxed);
+			outdatedWavefronts.push_back(component);
+			++component->evaluations;
+			component->evaluatedBlocks += component->size;
+		}
+		else
+			++component->skips;
+	}
+}
+
+int Simulator::StealTask(int threadIndex, backend::WorkQueue *&victim)
+{
+	int numberOfQueues = (int)workQueues.size();
+
+	// No work is added during the propagation phase. Once all other queues
+	// are found to be empty, there is nothing left to steal.
+	for (int i = 1; i < numberOfQueues; ++i) {
+
+		victim = &workQueues[(threadIndex + i) % numberOfQueues];
+
+		int task = victim->TakeBack();
+		if (task >= 0)
+			return task;
+	}
+
+	return -1;
+}
+
+void Simulator::EvaluateTask(backend::WorkQueue &queue, backend::WorkQueue const &owner, int task)
+{
+	for (int i = owner.taskStarts[task]; i < owner.taskStarts[task + 1]; ++i)
+		if (EvaluateComponent(*owner.components[i]))
+			++queue.evaluatedComponents;
+}
+
+// Returns 'false' if the component was skipped. The blocks behind a gate
+// are evaluated while its enable is high if the component was outdated
+// since they were last evaluated.
+bool Simulator::EvaluateComponent(backend::Component &component)
+{
+	bool outdated = component.outdated || !options.dirtyTracking;
+	component.outdated = false;
+
+	if (component.gates.empty()) {
+
+		if (!outdated) {
+
+			++component.skips;
+			return false;
+		}
+
+		++component.evaluations;
+
+		if (!component.pending.empty())
+			EvaluateEvents(component);
+		else {
+
+			component.evaluatedBlocks += component.size;
+			EvaluateSchedule(component, 0, component.size);
+		}
+
+		return true;
+	}
+
+	int evaluatedBlocks = 0;
+	int firstGated = component.gates.front().first;
+
+	if (outdated && firstGated > 0) {
+
+		EvaluateSchedule(component, 0, firstGated);
+		evaluatedBlocks += firstGated;
+	}
+
+	for (auto &gate : component.gates) {
+
+		gate.outdated = gate.outdated || outdated;
+
+		if (!*gate.enable)
+			++gate.skips;
+		else if (gate.outdated) {
+
+			gate.outdated = false;
+			EvaluateSchedule(component, gate.first, gate.last);
+			evaluatedBlocks += gate.last - gate.first;
+		}
+	}
+
+	if (evaluatedBlocks == 0) {
+
+		++component.skips;
+		return false;
+	}
+
+	++component.evaluations;
+	component.evaluatedBlocks += evaluatedBlocks;
+	return true;
+}
+
+void Simulator::PropagateCore(int threadIndex)
+{
+	auto &queue = workQueues[threadIndex];
+	auto start = std::chrono::steady_clock::now();
+
+	for (auto *component : outdatedWavefronts)
+		EvaluateWavefront(*component);
+
+	for (int task = queue.TakeFront(); task >= 0; task = queue.TakeFront())
+		EvaluateTask(queue, queue, task);
+
+	backend::WorkQueue *victim;
+
+	for (int task = StealTask(threadIndex, victim); task >= 0; task = StealTask(threadIndex, victim)) {
+
+		++queue.stolenTasks;
+		EvaluateTask(queue, *victim, task);
+	}
+
+	queue.busyTime += std::chrono::steady_clock::now() - start;
+}
+
+void Simulator::RunPhase(int phase, int threadIndex)
+{
+	switch (phase) {
+
+		case STATE_PROPAGATING:
+			PropagateCore(threadIndex);
+			break;
+
+		case STATE_STEPPING:
+			StepCore();
+			break;
+	}
+}
+
+unsigned Simulator::AwaitEpoch(unsigned lastEpoch)
+{
+	for (int i = 0; i < SPIN_LIMIT; ++i) {
+
+		unsigned epoch = runEpoch.load(std::memory_order_acquire);
+		if (epoch != lastEpoch)
+			return epoch;
+
+		CpuRelax(i);
+	}
+
+	// Nothing happened for a while. Park this thread until the main thread
+	// starts the next phase. The sequentially consistent accesses to
+	// 'parkedWorkers' and 'runEpoch' guarantee that the wake-up cannot be lost.
+	parkedWorkers.fetch_add(1);
+
+	std::unique_lock<std::mutex> lock(runMutex);
+	runCv.wait(lock, [this, lastEpoch] { return runEpoch.load() != lastEpoch; });
+	lock.unlock();
+
+	parkedWorkers.fetch_sub(1);
+
+	return runEpoch.load(std::memory_order_acquire);
+}
+
+void Simulator::AwaitPending()
+{
+	for (int i = 0; i < SPIN_LIMIT; ++i) {
+
+		if (runPending.load(std::memory_order_acquire) == 0)
+			return;
+
+		CpuRelax(i);
+	}
+
+	parkedMain.store(true);
+
+	std::unique_lock<std::mutex> lock(runMutex);
+	runDoneCv.wait(lock, [this] { return runPending.load() == 0; });
+
+	parkedMain.store(false);
+}
+
+void Simulator::RunWorkerThread(int *state, int threadIndex)
+{
+	if (options.synchronisation == Synchronisation::SpinThenPark) {
+
+		unsigned epoch = 0;
+
+		for (;;) {
+
+			epoch = AwaitEpoch(epoch);
+
+			int phase = runPhase.load(std::memory_order_relaxed);
+			if (phase == STATE_TERMINATING)
+				return;
+
+			RunPhase(phase, threadIndex);
+
+			// The last thread to finish wakes up the main thread if it gave up spinning.
+			if (runPending.fetch_sub(1) == 1 && parkedMain.load()) {
+
+				std::lock_guard<std::mutex> lock(runMutex);
+				runDoneCv.notify_one();
+			}
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(runMutex);
+
+	while (*state != STATE_TERMINATING) {
+
+		runCv.wait(lock, [state] { return *state != STATE_IDLE; });
+		lock.unlock();
+
+		if (*state == STATE_TERMINATING)
+			return;
+
+		RunPhase(*state, threadIndex);
+
+		lock.lock();
+		*state = STATE_IDLE;
+		runCv.notify_all();
+	}
+}
+
+void Simulator::StartPhase(int phase)
+{
+	runPhase.store(phase, std::memory_order_relaxed);
+	runPending.store((int)runThreads.size(), std::memory_order_relaxed);
+	runEpoch.fetch_add(1);
+
+	if (parkedWorkers.load() > 0) {
+
+		// Acquiring the mutex makes sure that a worker that is about to park
+		// either sees the new epoch or is already waiting for the notification.
+		{
+			std::lock_guard<std::mutex> lock(runMutex);
+		}
+
+		runCv.notify_all();
+	}
+}
+
+void Simulator::Propagate()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	// The gated components look at the enables computed here.
+	for (auto *component : leadingComponents)
+		if (EvaluateComponent(*component))
+			++workQueues.front().evaluatedComponents;
+
+	if (options.synchronisation == Synchronisation::SpinThenPark) {
+
+		ResetWorkQueues();
+		StartPhase(STATE_PROPAGATING);
+		PropagateCore(0);
+		AwaitPending();
+	}
+	else {
+
+		std::unique_lock<std::mutex> lock(runMutex);
+
+		ResetWorkQueues();
+		std::fill(runStates.begin(), runStates.end(), STATE_PROPAGATING);
+		runCv.notify_all();
+		lock.unlock();
+
+		PropagateCore(0);
+
+		lock.lock();
+		runCv.wait(lock, [this] { 
+			return std::all_of(runStates.cbegin(), runStates.cend(), [](int state) { return state == STATE_IDLE; });
+		});
+	}
+
+	propagateDuration += std::chrono::steady_clock::now() - start;
+}
+
+void Simulator::StepCore()
+{
+	// The groups of the register bank come first, followed by the blocks
+	// that step themselves.
+	int numberOfGroups = registerBank.GetNumberOfGroups();
+	int total = numberOfGroups + (int)steppingIndices.size();
+
+	int index = currentSteppableIndex.fetch_add(1, std::memory_order_relaxed);
+
+	while (index < total) {
+
+		if (index < numberOfGroups)
+			registerBank.StepGroup(index);
+		else if (stepProfile.empty())
+			steppables[steppingIndices[index - numberOfGroups]]->Step();
+		else {
+
+			int i = steppingIndices[index - numberOfGroups];
+
+			auto start = std::chrono::steady_clock::now();
+			steppables[i]->Step();
+
+			auto &profile = stepProfile[i];
+			profile.time += std::chrono::steady_clock::now() - start;
+			++profile.calls;
+		}
+
+		index = currentSteppableIndex.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+	
+
+void Simulator::Step()
+{
+	if (options.synchronisation == Synchronisation::SpinThenPark) {
+
+		currentSteppableIndex.store(0, std::memory_order_relaxed);
+		StartPhase(STATE_STEPPING);
+		StepCore();
+		AwaitPending();
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(runMutex);
+
+	currentSteppableIndex = 0;
+	std::fill(runStates.begin(), runStates.end(), STATE_STEPPING);
+	runCv.notify_all();
+	lock.unlock();
+
+	StepCore();
+
+	lock.lock();
+	runCv.wait(lock, [this] {
+		return std::all_of(runStates.cbegin(), runStates.cend(), [](int state) { return state == STATE_IDLE; });
+	});
+}
+
+void Simulator::Run(unsigned numberOfIterations /* = 1 */)
+{
+	AwaitAsyncRun();
+	RunCycles(numberOfIterations);
+}
+
+std::future<void> Simulator::RunAsync(unsigned numberOfIterations /* = 1 */)
+{
+	AwaitAsyncRun();
+
+	// The new thread takes the part of the calling thread in the phases of
+	// the run (thread index 0).
+	std::packaged_task<void()> task([this, numberOfIterations] { RunCycles(numberOfIterations); });
+	auto result = task.get_future();
+
+	asyncThread = std::thread(std::move(task));
+	return result;
+}
+
+// Waits for the thread of the last call to RunAsync(), which reports the
+// outcome of the run through its future.
+void Simulator::AwaitAsyncRun()
+{
+	if (asyncThread.joinable())
+		asyncThread.join();
+}
+
+void Simulator::RunCycles(unsigned numberOfIterations)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	cycleCount += numberOfIterations;
+
+	Propagate();
+
+	while (numberOfIterations-- > 0) {
+
+		Step();
+		Propagate();
+	}
+
+	runDuration += std::chrono::steady_clock::now() - start;
+}
+
+// Returns the value of the output pin that computes the condition during
+// the simulation. This is the pin of the block the driving block was merged
+// into, if any.
+bool const *Simulator::GetConditionValue(node<bool> const &condition) const
+{
+	auto const *pin = condition.GetDriver();
+
+	if (pin == nullptr)
+		throw design_error("Simulator::RunUntil: the condition is not connected.");
+
+	auto const *block = pin->GetOwner();
+
+	for (auto it = mergedBlocks.find(block); it != mergedBlocks.end(); it = mergedBlocks.find(block))
+		block = it->second;
+
+	if (block->excluded && std::find(foldedBlocks.begin(), foldedBlocks.end(), block) == foldedBlocks.end())
+		throw design_error("Simulator::RunUntil: the condition driven by block '" + block->GetFullName() + "' is not evaluated, because it is not observed. Add a probe to the condition before creating the simulator.");
+
+	auto const *component = block->component;
+
+	if (component != nullptr && !component->gates.empty() && block->scheduleIndex >= component->gates.front().first)
+		throw design_error("Simulator::RunUntil: the condition driven by block '" + block->GetFullName() + "' is not evaluated while the clock enable of the blocks it leads to is low. Add a probe to the condition before creating the simulator.");
+
+	bool const *value = static_cast<backend::OutputPin<bool> const *>(block->GetOutputPins()[pin->GetIndex()])->valuePointer;
+
+	if (registerBank.IsUntapped(value))
+		throw design_error("Simulator::RunUntil: the condition driven by block '" + block->GetFullName() + "' is not updated, because it is an inner stage of a delay line. Add a probe to the condition before creating the simulator.");
+
+	return value;
+}
+
+std::uint64_t Simulator::RunUntil(node<bool> const &condition, std::uint64_t maxCycles)
+{
+	AwaitAsyncRun();
+	return RunUntilAny({ GetConditionValue(condition) }, maxCycles);
+}
+
+std::uint64_t Simulator::RunUntil(std::vector<node<bool>> const &conditions, std::uint64_t maxCycles)
+{
+	AwaitAsyncRun();
+
+	std::vector<bool const *> values;
+	values.reserve(conditions.size());
+
+	for (auto const &condition : conditions)
+		values.push_back(GetConditionValue(condition));
+
+	return RunUntilAny(values, maxCycles);
+}
+
+std::uint64_t Simulator::RunUntilAny(std::vector<bool const *> const &conditions, std::uint64_t maxCycles)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto const &layout = valueArena.GetLayout();
+
+	auto isTrue = [&conditions, &layout]() {
+
+		for (auto const *value : conditions)
+			for (int lane = 0; lane < layout.lanes; ++lane)
+				if (layout.Get(value, lane))
+					return true;
+
+		return false;
+	};
+
+	std::uint64_t cycles = 0;
+
+	Propagate();
+
+	while (cycles < maxCycles && !isTrue()) {
+
+		Step();
+		Propagate();
+		++cycles;
+	}
+
+	cycleCount += cycles;
+	runDuration += std::chrono::steady_clock::now() - start;
+
+	return cycles;
+}
+
+void Simulator::AsyncReset()
+{
+	AwaitAsyncRun();
+
+	for (auto *steppable : steppables)
+		steppable->AsyncReset();
+
+	registerBank.Reload();
+	Propagate();
+}
+
+static char const stateMagic[8] = { 'O', 'D', 'D', 'F', 'S', 'I', 'M', 'S' };
+static std::uint32_t const stateVersion = 1;
+
+SimulatorState Simulator::SaveState() const
+{
+	SimulatorState state;
+	backend::StateWriter writer(state.data);
+
+	registerBank.Synchronise();
+
+	writer.WriteBytes(stateMagic, sizeof(stateMagic));
+	writer.Write(stateVersion);
+	writer.Write((std::uint64_t)blocks.size());
+	writer.Write((std::uint64_t)steppables.size());
+	writer.Write(valueArena.GetLayout().lanes);
+	writer.Write(valueArena.GetLayout().packedBooleans);
+	writer.Write(cycleCount);
+
+	for (auto *block : blocks)
+		for (auto *pin : block->GetOutputPins())
+			pin->SaveValue(writer, valueArena);
+
+	for (auto *steppable : steppables)
+		steppable->SaveState(writer);
+
+	return state;
+}
+
+void Simulator::RestoreState(SimulatorState const &state)
+{
+	AwaitAsyncRun();
+
+	backend::StateReader reader(state.data);
+
+	char magic[sizeof(stateMagic)];
+	reader.ReadBytes(magic, sizeof(magic));
+
+	if (std::memcmp(magic, stateMagic, sizeof(magic)) != 0)
+		throw design_error("The data is not a simulator state.");
+
+	reader.Expect(stateVersion, "format version");
+	reader.Expect((std::uint64_t)blocks.size(), "number of blocks");
+	reader.Expect((std::uint64_t)steppables.size(), "number of clocked blocks");
+	reader.Expect(valueArena.GetLayout().lanes, "number of lanes");
+	reader.Expect(valueArena.GetLayout().packedBooleans, "packing of booleans");
+
+	// The blocks only find out while reading whether the rest of the state
+	// fits them. If it does not, the simulator goes back to a snapshot of
+	// its current state, which skips the same header.
+	auto current = SaveState();
+	std::vector<char> header(state.data.size() - reader.GetRemainingSize());
+
+	try {
+
+		ReadState(reader);
+	}
+	catch (...) {
+
+		backend::StateReader currentReader(current.data);
+
+		currentReader.ReadBytes(header.data(), header.size());
+		ReadState(currentReader);
+
+		throw;
+	}
+
+	// Also covers blocks whose evaluation depends on state outside the
+	// snapshot, such as signals.
+	for (auto &component : components) {
+
+		component.outdated = true;
+		std::fill(component.pending.begin(), component.pending.end(), 1);
+	}
+}
+
+// Reads the part of a state that follows the header.
+void Simulator::ReadState(backend::StateReader &reader)
+{
+	reader.Read(cycleCount);
+
+	for (auto *block : blocks)
+		for (auto *pin : block->GetOutputPins())
+			pin->RestoreValue(reader, valueArena);
+
+	for (auto *steppable : steppables)
+		steppable->RestoreState(reader);
+
+	registerBank.Reload();
+
+	if (!reader.IsAtEnd())
+		backend::StateReader::Mismatch("size of the state");
+}
+
+Simulator::Options const &Simulator::GetOptions() const
+{
+	return options;
+}
+
+std::list<backend::Component> &Simulator::GetComponents()
+{
+	return components;
+}
+
+backend::RegisterBank &Simulator::GetRegisterBank()
+{
+	return registerBank;
+}
+
+void Simulator::Report(std::basic_ostream<char> &os) const
+{
+	using std::endl;
+	using std::setw;
+
+	std::map<int, int> componentSizes;
+	for (auto const &component : components)
+		componentSizes[(int)std::ceil(std::log2(component.size))]++;
+
+	os << " --- Simulator --- " << endl << endl;
+
+	os << " Number of components        : " << components.size() << endl;
+
+	if (!scheduleCacheFile.empty())
+		os << " Schedule                    : " << (scheduleFromCache ? "loaded from " : "saved to ") << scheduleCacheFile << endl;
+
+	os << " Number of computable blocks : " << std::accumulate(components.begin(), components.end(), 0, [](int current, backend::Component const &component) { return current + component.size; }) << endl;
+	os << " Number of steppable blocks  : " << steppables.size() << endl;
+
+	if (options.mergeEquivalentBlocks)
+		os << " Merged equivalent blocks    : " << mergedBlocks.size() << endl;
+
+	if (options.optimiseExecutionGraph) {
+
+		os << " Folded constant blocks      : " << foldedBlocks.size() << endl;
+		os << " Removed unobserved blocks   : " << numberOfDeadBlocks << endl;
+	}
+
+	os << " Registers in register bank  : " << registerBank.GetNumberOfRegisters() << " (" << registerBank.GetNumberOfGroups() << " groups)" << endl;
+
+	if (registerBank.GetNumberOfLines() > 0)
+		os << " Delay lines                 : " << registerBank.GetNumberOfLines() << " (" << registerBank.GetNumberOfLineRegisters() << " registers)" << endl;
+
+	if (options.clockEnableGating) {
+
+		// The share of the propagation phases with a low enable is weighted
+		// by the number of blocks behind the gates.
+		int numberOfGates = 0;
+		int numberOfGatedBlocks = 0;
+		std::uint64_t skippedBlocks = 0;
+		std::uint64_t totalBlocks = 0;
+
+		for (auto const &component : components) {
+
+			for (auto const &gate : component.gates) {
+
+				int size = gate.last - gate.first;
+
+				++numberOfGates;
+				numberOfGatedBlocks += size;
+				skippedBlocks += gate.skips * size;
+				totalBlocks += (component.evaluations + component.skips) * size;
+			}
+		}
+
+		os << " Gated blocks                : " << numberOfGatedBlocks << " (" << numberOfGates << " gates, " << leadingComponents.size() << " leading components, enable low in "
+			<< string_printf("%.1f %%", totalBlocks > 0 ? 100.0 * skippedBlocks / totalBlocks : 0.0) << ")" << endl;
+	}
+
+	os << " Number of parallel threads  : " << runThreads.size() + 1 << endl;
+	os << " Thread synchronisation      : " << (options.synchronisation == Synchronisation::SpinThenPark ? "spin-then-park" : "condition variable") << endl;
+	os << " Dirty tracking              : " << (options.dirtyTracking ? (options.eventDriven ? "event-driven" : "on") : "off") << endl;
+	os << " Engine                      : " << (options.engine == Engine::Bytecode ? "bytecode" : "blocks") << endl;
+	os << " Lanes                       : " << options.lanes << (options.packedBooleans ? " (packed booleans)" : "") << endl;
+
+	if (options.engine == Engine::Bytecode) {
+
+		int numberOfInstructions = 0;
+		int numberOfCalls = 0;
+		int numberOfNativeComponents = 0;
+
+		for (auto const &component : components) {
+
+			numberOfInstructions += component.program.GetNumberOfInstructions();
+			numberOfCalls += component.program.GetNumberOfCalls();
+			numberOfNativeComponents += component.program.IsNative() ? 1 : 0;
+		}
+
+		os << " Number of instructions      : " << numberOfInstructions << " (" << numberOfCalls << " calls to Evaluate())" << endl;
+
+		if (numberOfNativeComponents > 0)
+			os << " Natively compiled components: " << numberOfNativeComponents << endl;
+	}
+
+	os << " Simulated clock cycles      : " << cycleCount << endl;
+
+	double seconds = std::chrono::duration<double>(runDuration).count();
+	if (seconds > 0)
+		os << " Clock cycles per second     : " << (std::uint64_t)(cycleCount / seconds) << endl;
+
+	os << endl;
+	os << " Components by size" << endl;
+	os << endl;
+
+	for (auto const &x : componentSizes)
+		os << setw(10) << (1 << x.first) << " : " << x.second << endl;
+
+	if (!wavefrontComponents.empty()) {
+
+		os << endl;
+		os << " Components evaluated as wavefront" << endl;
+		os << endl;
+		os << "    Blocks  Levels  Average width" << endl;
+
+		for (auto const *component : wavefrontComponents) {
+
+			int levels = (int)component->wavefrontLevels.size() - 1;
+			os << setw(10) << component->size << setw(8) << levels << setw(15) << component->size / levels << endl;
+		}
+	}
+
+	os << endl;
+	valueArena.Report(os);
+
+	os << endl;
+	os << " Work-stealing scheduler (busy and idle time relative to the propagation phase," << endl;
+	os << " planned cost and busy time relative to all threads)" << endl;
+	os << endl;
+	os << "    Thread  Planned blocks  Planned cost  Tasks  Evaluated components  Stolen tasks    Busy    Idle  Cost share  Busy share" << endl;
+
+	double propagateSeconds = std::chrono::duration<double>(propagateDuration).count();
+
+	double totalCost = 0;
+	double totalBusy = 0;
+
+	for (auto const &queue : workQueues) {
+
+		totalCost += queue.plannedCost;
+		totalBusy += std::chrono::duration<double>(queue.busyTime).count();
+	}
+
+	double maximumCost = 0;
+	double maximumBusy = 0;
+
+	for (int i = 0; i < (int)workQueues.size(); ++i) {
+
+		auto const &queue = workQueues[i];
+
+		double busySeconds = std::chrono::duration<double>(queue.busyTime).count();
+		double busy = propagateSeconds > 0 ? std::min(1.0, busySeconds / propagateSeconds) : 0.0;
+		double costShare = totalCost > 0 ? queue.plannedCost / totalCost : 0.0;
+		double busyShare = totalBusy > 0 ? busySeconds / totalBusy : 0.0;
+
+		maximumCost = std::max(maximumCost, queue.plannedCost);
+		maximumBusy = std::max(maximumBusy, busySeconds);
+
+		os << setw(10) << i << setw(16) << queue.plannedSize << setw(11) << (std::uint64_t)std::lround(queue.plannedCost) << " ns" << setw(7) << queue.NumberOfTasks()
+			<< setw(22) << queue.evaluatedComponents << setw(14) << queue.stolenTasks
+			<< setw(7) << (int)std::lround(100 * busy) << " %" << setw(6) << (int)std::lround(100 * (1 - busy)) << " %"
+			<< setw(10) << (int)std::lround(100 * costShare) << " %" << setw(10) << (int)std::lround(100 * busyShare) << " %" << endl;
+	}
+
+	// Ratio of the most loaded thread to the average. 1 is a perfect balance.
+	int numberOfQueues = (int)workQueues.size();
+
+	os << endl;
+	os << " Load imbalance, predicted   : " << string_printf("%.2f", totalCost > 0 ? maximumCost * numberOfQueues / totalCost : 1.0) << endl;
+	os << " Load imbalance, measured    : " << string_printf("%.2f", totalBusy > 0 ? maximumBusy * numberOfQueues / totalBusy : 1.0) << endl;
+	os << endl;
+
+	ReportActivity(os);
+
+	if (options.profiling)
+		ReportProfile(os);
+}
+
+void Simulator::ReportActivity(std::basic_ostream<char> &os) const
+{
+	using std::endl;
+	using std::setw;
+
+	// Histogram over the activity rate in steps of 10 %. Rows are components,
+	// blocks in these components and clocked blocks.
+	std::uint64_t histogram[11][3] = {};
+
+	auto bucket = [](std::uint64_t active, std::uint64_t count) {
+
+		return count > 0 ? (int)(10 * active / count) : 0;
+	};
+
+	std::uint64_t evaluatedBlocks = 0;
+	std::uint64_t phases = 0;
+
+	for (auto const &component : components) {
+
+		std::uint64_t count = component.evaluations + component.skips;
+		auto &row = histogram[bucket(component.evaluations, count)];
+
+		row[0] += 1;
+		row[1] += component.size;
+
+		evaluatedBlocks += component.evaluatedBlocks;
+		phases = std::max(phases, count);
+	}
+
+	std::uint64_t numberOfBlocks = std::accumulate(components.begin(), components.end(), (std::uint64_t)0, [](std::uint64_t current, backend::Component const &component) { return current + component.size; });
+
+	std::uint64_t steps = 0;
+	std::uint64_t changes = 0;
+
+	for (auto *steppable : steppables) {
+
+		if (auto *activity = steppable->GetActivity()) {
+
+			histogram[bucket(activity->changes, activity->steps)][2] += 1;
+			steps += activity->steps;
+			changes += activity->changes;
+		}
+	}
+
+	os << " Activity (fraction of propagation phases in which a component was evaluated" << endl;
+	os << " and of clock cycles in which a delay block changed its state)" << endl;
+	os << endl;
+	os << " Evaluated blocks            : " << string_printf("%.1f %%", numberOfBlocks * phases > 0 ? 100.0 * evaluatedBlocks / (numberOfBlocks * phases) : 0.0) << endl;
+	os << " Changed delay blocks        : " << string_printf("%.1f %%", steps > 0 ? 100.0 * changes / steps : 0.0) << endl;
+	os << endl;
+	os << "      Activity  Components    Blocks  Delay blocks" << endl;
+
+	for (int i = 0; i < 10; ++i) {
+
+		// 100 % belongs to the last bucket.
+		std::uint64_t row[3];
+		for (int j = 0; j < 3; ++j)
+			row[j] = histogram[i][j] + (i == 9 ? histogram[10][j] : 0);
+
+		os << setw(7) << 10 * i << "-" << setw(3) << 10 * (i + 1) << " %" << setw(12) << row[0] << setw(10) << row[1] << setw(14) << row[2] << endl;
+	}
+
+	os << endl;
+}
+
+// Label of a profiled block. Step() is counted separately from Evaluate().
+static std::string GetProfileLabel(backend::BlockProfile const &profile, bool step)
+{
+	return profile.block->GetClassName() + (step ? ".Step" : "");
+}
+
+struct ProfileRow {
+
+	std::uint64_t calls;
+	std::chrono::steady_clock::duration time;
+
+	ProfileRow() : calls(0), time(0) {}
+};
+
+// Prints the rows ranked by total time. Shares are given relative to the
+// duration of Run(), so they add up to more than 100 % with several threads.
+static void PrintProfile(std::basic_ostream<char> &os, std::string const &title, std::map<std::string, ProfileRow> const &rows, std::chrono::steady_clock::duration runDuration, int maximumRows)
+{
+	using std::endl;
+	using std::setw;
+
+	std::vector<std::pair<std::string, ProfileRow>> ranked(rows.begin(), rows.end());
+
+	std::stable_sort(ranked.begin(), ranked.end(), [](std::pair<std::string, ProfileRow> const &row1, std::pair<std::string, ProfileRow> const &row2) {
+		return row1.second.time > row2.second.time;
+	});
+
+	double runNanoseconds = std::chrono::duration<double, std::nano>(runDuration).count();
+
+	os << " " << title << endl;
+	os << endl;
+	os << "    " << std::left << setw(40) << "Name" << std::right << setw(14) << "Calls" << setw(18) << "Total ns" << setw(10) << "ns/call" << setw(9) << "Share" << endl;
+
+	for (int i = 0; i < (int)ranked.size() && i < maximumRows; ++i) {
+
+		auto const &row = ranked[i].second;
+		double nanoseconds = std::chrono::duration<double, std::nano>(row.time).count();
+
+		os << "    " << std::left << setw(40) << ranked[i].first << std::right << setw(14) << row.calls << setw(18) << (std::uint64_t)nanoseconds
+			<< setw(10) << string_printf("%.1f", row.calls > 0 ? nanoseconds / row.calls : 0.0)
+			<< setw(7) << string_printf("%.1f", runNanoseconds > 0 ? 100 * nanoseconds / runNanoseconds : 0.0) << " %" << endl;
+	}
+
+	if ((int)ranked.size() > maximumRows)
+		os << "    (" << ranked.size() - maximumRows << " more)" << endl;
 
 	os << endl;
 }
 
+void Simulator::ReportProfile(std::basic_ostream<char> &os) const
+{
+	if (!options.profiling)
+		throw design_error("Simulator::ReportProfile() requires the simulator option 'profiling'.");
+
+	std::map<std::string, ProfileRow> classes;
+	std::map<std::string, ProfileRow> levels;
+
+	auto add = [&](backend::BlockProfile const &profile, bool step) {
+
+		for (auto *row : { &classes[GetProfileLabel(profile, step)], &levels[profile.block->GetHierarchyString()] }) {
+
+			row->calls += profile.calls;
+			row->time += profile.time;
+		}
+	};
+
+	for (auto const &component : components)
+		for (auto const &profile : component.profile)
+			add(profile, false);
+
+	for (auto const &profile : stepProfile)
+		add(profile, true);
+
+	os << " --- Profile --- " << std::endl << std::endl;
+
+	PrintProfile(os, "Time by block class", classes, runDuration, (int)classes.size());
+	PrintProfile(os, "Time by hierarchy level (without sublevels)", levels, runDuration, 25);
+}
+
+void Simulator::WriteActivity(std::basic_ostream<char> &os) const
+{
+	using std::endl;
+
+	os << "kind,name,blocks,count,active" << endl;
+
+	for (auto const &component : components)
+		os << "component,\"" << component.schedule.front()->GetFullName() << "\"," << component.size << "," << component.evaluations + component.skips << "," << component.evaluations << endl;
+
+	for (auto *block : blocks) {
+
+		auto *steppable = block->GetStep();
+		if (steppable == nullptr)
+			continue;
+
+		if (auto *activity = steppable->GetActivity())
+			os << "delay,\"" << block->GetFullName() << "\",1," << activity->steps << "," << activity->changes << endl;
+	}
+}
+
+void Simulator::WriteFoldedStacks(std::basic_ostream<char> &os) const
+{
+	if (!options.profiling)
+		throw design_error("Simulator::WriteFoldedStacks() requires the simulator option 'profiling'.");
+
+	std::map<std::string, ProfileRow> stacks;
+
+	auto add = [&](backend::BlockProfile const &profile, bool step) {
+
+		std::string stack;
+
+		for (char c : profile.block->GetHierarchyString()) {
+
+			if (c != '/')
+				stack += c;
+			else if (!stack.empty() && stack.back() != ';')
+				stack += ';';
+		}
+
+		if (!stack.empty() && stack.back() != ';')
+			stack += ';';
+
+		auto &row = stacks[stack + GetProfileLabel(profile, step)];
+		row.calls += profile.calls;
+		row.time += profile.time;
+	};
+
+	for (auto const &component : components)
+		for (auto const &profile : component.profile)
+			add(profile, false);
+
+	for (auto const &profile : stepProfile)
+		add(profile, true);
+
+	for (auto const &stack : stacks)
+		os << stack.first << " " << std::chrono::duration_cast<std::chrono::nanoseconds>(stack.second.time).count() << std::endl;
+}
 
 }
@@ -27,67 +27,514 @@
 #pragma once
 
 #include "node.h"
+#include "cost_model.h"
+#include "register_bank.h"
 
 namespace dfx {
 
 namespace backend {
 
+// Time spent in Evaluate() or Step() of one block. Only collected if
+// Simulator::Options::profiling is set.
+struct BlockProfile {
+
+	BlockBase const *block;
+	std::uint64_t calls;
+	std::chrono::steady_clock::duration time;
+
+	BlockProfile(BlockBase const *block) : block(block), calls(0), time(0) {}
+};
+
+// A range of the schedule of a component that is only evaluated while an
+// enable is high (see Simulator::Options::clockEnableGating).
+struct Gate {
+
+	bool const *enable;
+	int first;
+	int last;
+
+	// Set if the component was outdated while the enable was low.
+	bool outdated;
+
+	// Number of propagation phases in which the enable was low.
+	std::uint64_t skips;
+
+	Gate(bool const *enable, int first) : enable(enable), first(first), last(first), outdated(true), skips(0) {}
+};
+
 class Component {
 
 public:
 
 	int sortingOrder;
 	int size;
+
+	// Estimated cost of evaluating all blocks (see CostModel).
+	double cost;
+
 	BlockBase *blocksFirst;
 	BlockBase **blocksEnd;
 	bool outdated;
 
-	Component() : size(0), blocksFirst(nullptr), blocksEnd(&blocksFirst), outdated(true) {}
+	// The blocks in evaluation order, compiled from the linked list once the
+	// execution graph is complete.
+	std::vector<BlockBase *> schedule;
+
+	// The schedule lowered to bytecode. Empty unless Engine::Bytecode is used.
+	Program program;
+
+	// Large components are evaluated as a wavefront by all threads together.
+	// Their schedule is sorted by topological level and 'wavefrontLevels'
+	// holds the index of the first block of every level plus the total number
+	// of blocks. Empty for all other components.
+	std::vector<int> wavefrontLevels;
+	std::atomic<int> wavefrontCursor;
+	std::atomic<int> wavefrontDone;
+
+	// One entry per block of the schedule if profiling is enabled.
+	std::vector<BlockProfile> profile;
+
+	// Event-driven evaluation: one flag per block of the schedule, set if the
+	// block has to be evaluated, and the schedule indices of the blocks reading
+	// the outputs of every block. 'fanoutStarts' holds the first index into
+	// 'fanout' for every block plus the total. Empty for the component mode.
+	std::vector<char> pending;
+	std::vector<int> fanoutStarts;
+	std::vector<int> fanout;
+
+	// Clock-enable gating: the blocks whose outputs only lead to clocked
+	// blocks with a common enable are moved to the end of the schedule, one
+	// gate per enable. 'leading' is set for the components that compute such
+	// an enable for other components. They are evaluated before all others.
+	std::vector<Gate> gates;
+	bool leading;
+
+	// Number of propagation phases that evaluated or skipped the component,
+	// and the total number of block evaluations.
+	std::uint64_t evaluations;
+	std::uint64_t skips;
+	std::uint64_t evaluatedBlocks;
+
+	Component() : size(0), cost(0), blocksFirst(nullptr), blocksEnd(&blocksFirst), outdated(true), schedule(), wavefrontLevels(), wavefrontCursor(0), wavefrontDone(0), profile(), pending(), fanoutStarts(), fanout(), gates(), leading(false), evaluations(0), skips(0), evaluatedBlocks(0) {}
+};
+
+//
+// WorkQueue: the tasks assigned to one simulator thread. A task is a run of
+// one or more components. During the propagation phase the owning thread
+// takes tasks from the front while idle threads steal from the back. Head and
+// tail indices are packed into a single atomic so that both ends can be
+// updated without a lock.
+//
+
+struct alignas(64) WorkQueue {
+
+	std::vector<Component *> components;
+
+	// Index of the first component of every task plus the total number of
+	// components.
+	std::vector<int> taskStarts;
+
+	std::atomic<std::uint64_t> range;
+
+	// Number of blocks and estimated cost assigned to this queue by the
+	// partitioning, including the share of the wavefront components.
+	int plannedSize;
+	double plannedCost;
+
+	// Statistics, only written by the thread owning this queue.
+	std::uint64_t evaluatedComponents;
+	std::uint64_t stolenTasks;
+	std::chrono::steady_clock::duration busyTime;
+
+	WorkQueue() : components(), taskStarts(1, 0), range(0), plannedSize(0), plannedCost(0), evaluatedComponents(0), stolenTasks(0), busyTime(0) {}
+
+	int NumberOfTasks() const
+	{
+		return (int)taskStarts.size() - 1;
+	}
+
+	void Reset()
+	{
+		range.store((std::uint64_t)NumberOfTasks() << 32, std::memory_order_relaxed);
+	}
+
+	// Returns the index of the task taken or -1 if the queue is empty.
+	int TakeFront()
+	{
+		std::uint64_t current = range.load(std::memory_order_relaxed);
+
+		while ((std::uint32_t)current < (std::uint32_t)(current >> 32)) {
+
+			if (range.compare_exchange_weak(current, current + 1, std::memory_order_relaxed))
+				return (int)(std::uint32_t)current;
+		}
+
+		return -1;
+	}
+
+	int TakeBack()
+	{
+		std::uint64_t current = range.load(std::memory_order_relaxed);
+
+		while ((std::uint32_t)current < (std::uint32_t)(current >> 32)) {
+
+			if (range.compare_exchange_weak(current, current - ((std::uint64_t)1 << 32), std::memory_order_relaxed))
+				return (int)(std::uint32_t)(current >> 32) - 1;
+		}
+
+		return -1;
+	}
 };
 
 }
 
+//
+// SimulatorState: snapshot of a simulation taken by Simulator::SaveState().
+// The snapshot can be kept in memory or written to a file and restored into
+// any simulator of the same design with the same lane settings.
+//
+
+class SimulatorState {
+
+private:
+
+	std::vector<char> data;
+
+	friend class Simulator;
+
+public:
+
+	bool IsEmpty() const;
+
+	void WriteToFile(std::string const &fileName) const;
+	void ReadFromFile(std::string const &fileName);
+};
+
 class Simulator {
 
+public:
+
+	// Determines how the main thread hands the propagation and step phases
+	// over to the worker threads.
+	enum class Synchronisation {
+
+		// Worker threads sleep on a condition variable between phases. Lowest
+		// CPU usage, but every phase pays the full wake-up latency.
+		ConditionVariable,
+
+		// Worker threads watch an epoch counter and spin for a bounded number
+		// of iterations before they park. Lowest latency for designs in which
+		// a clock cycle takes only a few microseconds to evaluate.
+		SpinThenPark
+	};
+
+	// Determines how blocks are evaluated.
+	enum class Engine {
+
+		// Every block is evaluated by a virtual call to Evaluate().
+		Blocks,
+
+		// The schedule is lowered to a flat instruction stream. Blocks without
+		// a lowering are still called through Evaluate().
+		Bytecode
+	};
+
+	enum class Mode {
+
+		// All blocks are evaluated on the calling thread.
+		Serial,
+
+		// Components are distributed over several threads.
+		Parallel
+	};
+
+	// Runtime settings of the simulator.
+	struct Options {
+
+		Mode mode;
+		Engine engine;
+
+		// Total number of threads including the calling thread. Zero selects one
+		// thread less than the number of hardware threads. Ignored in serial mode.
+		int numberOfThreads;
+
+		// Logical processors the worker threads are pinned to. Worker thread i
+		// (counting from 1) runs on 'cores[(i - 1) % cores.size()]'. The calling
+		// thread is left alone. If empty, no thread is pinned.
+		std::vector<int> cores;
+
+		Synchronisation synchronisation;
+
+		// Small components are combined into tasks with an estimated cost of at
+		// least this many simple blocks (see CostModel). Tasks are the unit of
+		// work stealing between threads.
+		int taskSize;
+
+		// Components with at least this many blocks, or with more than the
+		// estimated cost of one thread, are evaluated as a wavefront by all
+		// threads together. Threads claim 'wavefrontChunkSize' blocks at once.
+		int wavefrontThreshold;
+		int wavefrontChunkSize;
+
+		// If set, only components with changed inputs are evaluated in every
+		// clock cycle. Otherwise, all components are evaluated.
+		bool dirtyTracking;
+
+		// If set, the blocks of an outdated component are evaluated only if one
+		// of their inputs changed. Every block whose outputs changed schedules
+		// the blocks reading them. Pays off for large components of which only
+		// a small part is active in a clock cycle. Requires Engine::Blocks and
+		// 'dirtyTracking'. Components are not split into wavefronts.
+		bool eventDriven;
+
+		// Number of independent simulations run through the design at once.
+		// Every output pin holds one value per lane, and the bytecode kernels
+		// loop over the lanes. Requires Engine::Bytecode and blocks that
+		// support lanes (see BlockBase::SetLanes()). Signals, sources and
+		// sinks take and provide data per lane.
+		int lanes;
+
+		// If set, bool values are stored as bit vectors with 64 lanes per
+		// word, and the boolean blocks evaluate 64 lanes with one operation.
+		// Requires Engine::Bytecode.
+		bool packedBooleans;
+
+		// If set, the costs of the blocks are measured by calling Evaluate() on
+		// the design before the work is partitioned. Otherwise, the built-in
+		// estimates are used. Unclocked blocks must not have side effects.
+		bool calibrateCosts;
+
+		// If set, the time spent in every block is measured and can be shown by
+		// ReportProfile() and WriteFoldedStacks(). Blocks are then evaluated one
+		// by one, so natively compiled components run as bytecode.
+		bool profiling;
+
+		// If not empty, the schedule is saved to this directory under a name
+		// derived from a structural hash of the design. Simulators of an
+		// identical design load it from there instead of sorting the blocks.
+		std::string scheduleCacheDirectory;
+
+		// If set, blocks whose inputs are all driven by constants are evaluated
+		// once before the simulation instead of in every clock cycle, and
+		// blocks that lead neither to a clocked block nor to an observable
+		// block (see BlockBase::IsObservable()) are not evaluated at all.
+		bool optimiseExecutionGraph;
+
+		// If set, blocks that compute the same function of the same inputs are
+		// merged before the simulation: the inputs driven by a duplicate are
+		// connected to the first such block instead (see
+		// BlockBase::IsEquivalent()). This changes the connections of the
+		// design. Hierarchy levels can opt out, see
+		// HierarchyLevel::SetKeepDuplicates().
+		bool mergeEquivalentBlocks;
+
+		// If set, blocks whose outputs only lead to clocked blocks with a
+		// common enable, such as the delays of an EnabledScope, are not
+		// evaluated in clock cycles in which the enable is low. An enable
+		// computed by another component is only used if that component has an
+		// estimated cost of at most 'taskSize' simple blocks. Such components
+		// are evaluated first, by the calling thread. Has no effect with
+		// 'eventDriven', several lanes or packed booleans, and on components
+		// evaluated as a wavefront.
+		bool clockEnableGating;
+
+		Options();
+	};
+
 private:
 
+	Options options;
+
 	std::list<backend::Component> components;
 	std::list<backend::Component *> reusableComponents;
 	backend::Component *currentComponent;
 
 	std::vector<backend::IStep *> steppables;
 
-	void RecursiveBuildExecutionOrder(backend::BlockBase *current);
+	// States of delay blocks, stepped in bulk, and the indices into
+	// 'steppables' of the blocks that step themselves.
+	backend::RegisterBank registerBank;
+	std::vector<int> steppingIndices;
+
+	// One entry per steppable block if profiling is enabled.
+	std::vector<backend::BlockProfile> stepProfile;
+
+	// All blocks of the design in creation order. Defines the order of the
+	// values in a SimulatorState.
+	std::vector<backend::BlockBase *> blocks;
+
+	backend::CostModel costModel;
+
+	// Values of all output pins, relocated from the pins while the simulator exists.
+	backend::ValueArena valueArena;
+	std::vector<backend::OutputPinBase *> relocatedPins;
+
+	// Cache of the schedule (see Options::scheduleCacheDirectory)
+	std::uint64_t designHash;
+	std::string scheduleCacheFile;
+	bool scheduleFromCache;
+
+	std::uint64_t HashDesign() const;
+	bool LoadSchedule();
+	void SaveSchedule() const;
+
+	// Blocks excluded from the schedule by Options::optimiseExecutionGraph:
+	// the blocks with constant inputs in evaluation order, and the number of
+	// blocks whose outputs are not observed.
+	std::vector<backend::BlockBase *> foldedBlocks;
+	int numberOfDeadBlocks;
+
+	// Blocks merged into an equivalent block (see
+	// Options::mergeEquivalentBlocks), each with the block it was merged into.
+	std::unordered_map<backend::BlockBase const *, backend::BlockBase const *> mergedBlocks;
+
+	void MergeEquivalentBlocks();
+	void OptimiseExecutionGraph();
+	void GateComponents();
+	void EvaluateFoldedBlocks(std::vector<bool> const &laneBlocks);
+
+	void BuildExecutionOrder(Design const &design);
+	void MergeComponent(backend::Component *component);
+	void AddToExecutionOrder(backend::BlockBase *root, std::vector<std::pair<backend::BlockBase *, std::size_t>> &path, std::vector<backend::BlockBase *> &pending);
 	void Prepare();
 
 
 	std::atomic<int> currentSteppableIndex;
-	std::atomic<int> currentTaskIndex;
-	std::vector<std::list<backend::Component *>> tasks;
+	std::vector<backend::WorkQueue> workQueues;
+	std::vector<backend::Component *> wavefrontComponents;
+	std::vector<backend::Component *> outdatedWavefronts;
+
+	// Components computing the enable of gated components.
+	std::vector<backend::Component *> leadingComponents;
 
 	std::list<std::thread> runThreads;
 	std::list<int> runStates;
 	std::mutex runMutex;
 	std::condition_variable runCv;
 
+	// State used by Synchronisation::SpinThenPark
+	std::atomic<unsigned> runEpoch;
+	std::atomic<int> runPhase;
+	std::atomic<int> runPending;
+	std::atomic<int> parkedWorkers;
+	std::atomic<bool> parkedMain;
+	std::condition_variable runDoneCv;
+
+	// Thread calling the simulation on behalf of RunAsync()
+	std::thread asyncThread;
+
+	// Statistics
+	std::uint64_t cycleCount;
+	std::chrono::steady_clock::duration runDuration;
+	std::chrono::steady_clock::duration propagateDuration;
+
+	void CompileSchedule(backend::Component &component);
+	void RelocateValues(Design const &design);
+	void SetLanes(Design const &design, std::vector<bool> &laneBlocks);
+	void CheckLanes(backend::Component const &component, std::vector<bool> const &laneBlocks) const;
+	void EstimateCosts();
+	void LowerSchedule(backend::Component &component);
+	void BuildWavefront(backend::Component &component);
+	void BuildFanout(backend::Component &component);
+	void EvaluateWavefront(backend::Component &component);
+
+	void PartitionComponents(int numberOfThreads);
+	void ResetWorkQueues();
+	int StealTask(int threadIndex, backend::WorkQueue *&victim);
+	void EvaluateTask(backend::WorkQueue &queue, backend::WorkQueue const &owner, int task);
+	bool EvaluateComponent(backend::Component &component);
+
 	void Propagate();
-	void PropagateCore();
+	void PropagateCore(int threadIndex);
 
 	void Step();
 	void StepCore();
 
-	void RunWorkerThread(int *state);
+	void RunPhase(int phase, int threadIndex);
+	void StartPhase(int phase);
+	unsigned AwaitEpoch(unsigned lastEpoch);
+	void AwaitPending();
+
+	void RunWorkerThread(int *state, int threadIndex);
+	static void PinThread(std::thread &thread, int core);
+
+	bool const *GetConditionValue(node<bool> const &condition) const;
+	std::uint64_t RunUntilAny(std::vector<bool const *> const &conditions, std::uint64_t maxCycles);
+
+	void RunCycles(unsigned numberOfIterations);
+	void AwaitAsyncRun();
+
+	void ReadState(backend::StateReader &reader);
 
 public:
 
-	Simulator(Design const &design);
+	Simulator(Design const &design, Options const &options = Options());
 	~Simulator();
 
 	void Run(unsigned numberOfIterations = 1);
 
+	// Runs the clock cycles like Run(), but on a separate thread, and returns
+	// at once. The future becomes ready when the run completes and rethrows
+	// any exception of the run. Until then, the simulator and the design,
+	// including probes, signals and sources, must not be accessed, with the
+	// exception of the data handed over by Sink::Swap() and Logger::Swap(),
+	// which the user can process while the run is in progress. Run(),
+	// RunUntil(), RunAsync(), AsyncReset(), RestoreState() and the destructor
+	// wait for a run that is still in progress.
+	std::future<void> RunAsync(unsigned numberOfIterations = 1);
+
+	// Runs clock cycles until 'condition' is true, but at most 'maxCycles',
+	// and returns the number of cycles run. Returns zero if the condition is
+	// already true. The condition is checked by the calling thread between
+	// the clock cycles, while the worker threads wait for the next phase.
+	// With several lanes, the condition is true if it is true in any lane.
+	// The condition must be evaluated in every clock cycle, which a probe
+	// reading it guarantees if it exists when the simulator is created (see
+	// Options::optimiseExecutionGraph and Options::clockEnableGating).
+	std::uint64_t RunUntil(node<bool> const &condition, std::uint64_t maxCycles);
+
+	// Runs clock cycles until one of the conditions is true.
+	std::uint64_t RunUntil(std::vector<node<bool>> const &conditions, std::uint64_t maxCycles);
+
 	void AsyncReset();
 
+	// Captures the state of all clocked blocks, the values of all nodes and
+	// the cycle count. Restoring a state continues the simulation from the
+	// point it was saved at, e.g. to run several scenarios after a common
+	// initialisation. The data of sources and signals is not part of the state.
+	// A state that does not fit the simulator is rejected with a design_error
+	// and leaves the simulator unchanged.
+	SimulatorState SaveState() const;
+	void RestoreState(SimulatorState const &state);
+
 	void Report(std::basic_ostream<char> &os) const;
+
+	// Prints how often components were evaluated and delay blocks changed
+	// their state, as a histogram over the activity rate. Part of Report().
+	void ReportActivity(std::basic_ostream<char> &os) const;
+
+	// Prints the time spent per block class and per hierarchy level, ranked
+	// by total time. Requires Options::profiling.
+	void ReportProfile(std::basic_ostream<char> &os) const;
+
+	// Writes the time spent in nanoseconds in the folded-stack format read by
+	// flame-graph tools: one line per hierarchy level and block class, with
+	// the levels and the class separated by semicolons. Requires
+	// Options::profiling.
+	void WriteFoldedStacks(std::basic_ostream<char> &os) const;
+
+	// Writes the activity of all components and of all clocked blocks that
+	// record it as comma-separated values. Components are named after their
+	// first block. 'count' is the number of propagation phases or clock
+	// cycles, 'active' the number of them in which the component was
+	// evaluated or the block changed its state.
+	void WriteActivity(std::basic_ostream<char> &os) const;
+
+	// Access for code generators that replace the evaluation of components
+	// and the step of the register bank by native code (see lib/native).
+	Options const &GetOptions() const;
+	std::list<backend::Component> &GetComponents();
+	backend::RegisterBank &GetRegisterBank();
 };
 
 }
@@ -0,0 +1,161 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+
+/*
+
+	Implementation of the classes 'StateWriter', 'StateReader' and
+	'SimulatorState'.
+
+*/
+
+#include "global.h"
+
+namespace dfx {
+namespace backend {
+
+//
+// StateWriter
+//
+
+StateWriter::StateWriter(std::vector<char> &buffer) :
+	buffer(buffer)
+{
+}
+
+void StateWriter::WriteBytes(void const *data, std::size_t size)
+{
+	char const *bytes = static_cast<char const *>(data);
+	buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void StateWriter::Write(std::vector<bool> const &values)
+{
+	Write((std::uint64_t)values.size());
+
+	for (bool value : values)
+		Write(value);
+}
+
+void StateWriter::Write(std::string const &value)
+{
+	Write((std::uint64_t)value.size());
+	WriteBytes(value.data(), value.size());
+}
+
+
+//
+// StateReader
+//
+
+StateReader::StateReader(std::vector<char> const &buffer) :
+	buffer(buffer),
+	position(0)
+{
+}
+
+void StateReader::ReadBytes(void *data, std::size_t size)
+{
+	if (size > buffer.size() - position)
+		throw design_error("Simulator state ends unexpectedly. It was not saved from this design.");
+
+	std::memcpy(data, buffer.data() + position, size);
+	position += size;
+}
+
+bool StateReader::IsAtEnd() const
+{
+	return position == buffer.size();
+}
+
+std::size_t StateReader::GetRemainingSize() const
+{
+	return buffer.size() - position;
+}
+
+std::size_t StateReader::ReadSize()
+{
+	std::uint64_t size;
+	Read(size);
+
+	// Guards the allocation against corrupt sizes.
+	if (size > buffer.size() - position)
+		throw design_error("Simulator state ends unexpectedly. It was not saved from this design.");
+
+	return (std::size_t)size;
+}
+
+void StateReader::Read(std::vector<bool> &values)
+{
+	values.resize(ReadSize());
+
+	for (std::size_t i = 0; i < values.size(); ++i) {
+
+		bool value;
+		Read(value);
+		values[i] = value;
+	}
+}
+
+void StateReader::Read(std::string &value)
+{
+	value.resize(ReadSize());
+	ReadBytes(&value[0], value.size());
+}
+
+void StateReader::Mismatch(char const *what)
+{
+	throw design_error(std::string("Simulator state does not match the design: ") + what + " differs.");
+}
+
+}
+
+
+//
+// SimulatorState
+//
+
+bool SimulatorState::IsEmpty() const
+{
+	return data.empty();
+}
+
+void SimulatorState::WriteToFile(std::string const &fileName) const
+{
+	std::ofstream file(fileName, std::ios::binary);
+
+	if (!file.write(data.data(), data.size()))
+		throw design_error("Could not write simulator state to file '" + fileName + "'.");
+}
+
+void SimulatorState::ReadFromFile(std::string const &fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+
+	if (!file)
+		throw design_error("Could not open simulator state file '" + fileName + "'.");
+
+	data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	if (file.bad())
+		throw design_error("Could not read simulator state from file '" + fileName + "'.");
+}
+
+}
@@ -0,0 +1,139 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Binary serialisation of the simulation state (see Simulator::SaveState()).
+	Values are stored in the byte order of the host. State files can therefore
+	only be exchanged between hosts of the same architecture.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dfx {
+namespace backend {
+
+class StateWriter {
+
+private:
+
+	std::vector<char> &buffer;
+
+public:
+
+	explicit StateWriter(std::vector<char> &buffer);
+
+	void WriteBytes(void const *data, std::size_t size);
+
+	template<typename T>
+	void Write(T const &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "StateWriter: type cannot be written as raw bytes.");
+		WriteBytes(&value, sizeof(T));
+	}
+
+	template<typename T>
+	void Write(T const *values, std::size_t count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "StateWriter: type cannot be written as raw bytes.");
+		WriteBytes(values, count * sizeof(T));
+	}
+
+	template<typename T>
+	void Write(std::vector<T> const &values)
+	{
+		Write((std::uint64_t)values.size());
+		Write(values.data(), values.size());
+	}
+
+	void Write(std::vector<bool> const &values);
+	void Write(std::string const &value);
+};
+
+class StateReader {
+
+private:
+
+	std::vector<char> const &buffer;
+	std::size_t position;
+
+public:
+
+	explicit StateReader(std::vector<char> const &buffer);
+
+	// Throws if the state ends early.
+	void ReadBytes(void *data, std::size_t size);
+
+	bool IsAtEnd() const;
+	std::size_t GetRemainingSize() const;
+
+	template<typename T>
+	void Read(T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "StateReader: type cannot be read as raw bytes.");
+		ReadBytes(&value, sizeof(T));
+	}
+
+	template<typename T>
+	void Read(T *values, std::size_t count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "StateReader: type cannot be read as raw bytes.");
+		ReadBytes(values, count * sizeof(T));
+	}
+
+	template<typename T>
+	void Read(std::vector<T> &values)
+	{
+		values.resize(ReadSize());
+		Read(values.data(), values.size());
+	}
+
+	void Read(std::vector<bool> &values);
+	void Read(std::string &value);
+
+	// Reads a value that was written by Write(). Throws if it differs from
+	// 'expected', which indicates state of a different design. 'what' names
+	// the value in the message.
+	template<typename T>
+	void Expect(T const &expected, char const *what)
+	{
+		T value;
+		Read(value);
+
+		if (std::memcmp(&value, &expected, sizeof(T)) != 0)
+			Mismatch(what);
+	}
+
+	[[noreturn]] static void Mismatch(char const *what);
+
+private:
+
+	std::size_t ReadSize();
+};
+
+}
+}
@@ -0,0 +1,82 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Implementation of class 'ValueArena'.
+
+*/
+
+#include "global.h"
+
+namespace dfx {
+namespace backend {
+
+static char const *GetClassName(types::TypeDescription::Class typeClass)
+{
+	switch (typeClass) {
+
+		case types::TypeDescription::Boolean:
+			return "bool";
+
+		case types::TypeDescription::Double:
+			return "double";
+
+		case types::TypeDescription::Int32:
+			return "int32";
+
+		case types::TypeDescription::Int64:
+			return "int64";
+
+		case types::TypeDescription::FixedPoint:
+			return "dynfix";
+
+		default:
+			return "unknown";
+	}
+}
+
+ValueArena::ValueArena(LaneLayout const &layout) :
+	layout(layout),
+	pools()
+{
+}
+
+void ValueArena::Report(std::basic_ostream<char> &os) const
+{
+	std::map<std::string, std::pair<std::size_t, std::size_t>> rows;
+
+	for (auto const &pool : pools) {
+
+		auto &row = rows[GetClassName(pool.second->typeClass)];
+		row.first += pool.second->GetSize();
+		row.second += pool.second->GetBytes();
+	}
+
+	os << " Pin values by type" << std::endl;
+	os << std::endl;
+	os << "    Type        Values         Bytes" << std::endl;
+
+	for (auto const &row : rows)
+		os << "    " << std::setw(6) << std::left << row.first << std::right << std::setw(12) << row.second.first << std::setw(14) << row.second.second << std::endl;
+}
+
+}
+}
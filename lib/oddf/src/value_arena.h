@@ -0,0 +1,256 @@
+/*
+
+	ODDF - Open Digital Design Framework
+	Copyright Advantest Corporation
+	
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 3 of the License, or
+	(at your option) any later version.
+	
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+	
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+*/
+
+/*
+
+	Dense per-type storage for the values of output pins. While a simulator
+	exists, the values of all output pins live in its arena, laid out in
+	evaluation order, so that consecutive blocks read and write adjacent
+	memory. Each pin occupies one value per lane, or one bit per lane for
+	packed bool values.
+
+*/
+
+#pragma once
+
+#include "types.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <typeindex>
+#include <unordered_map>
+
+namespace dfx {
+namespace backend {
+
+// Access to the 64-bit words of packed bool values. Packed values are only
+// accessed through these functions, never as bool.
+inline std::uint64_t LoadWord(bool const *values, int word)
+{
+	std::uint64_t bits;
+	std::memcpy(&bits, values + 8 * word, sizeof(bits));
+	return bits;
+}
+
+inline void StoreWord(bool *values, int word, std::uint64_t bits)
+{
+	std::memcpy(values + 8 * word, &bits, sizeof(bits));
+}
+
+// Layout of the values of all lanes of a pin (see Simulator::Options::lanes).
+// The values of the lanes follow each other, except for bool values if
+// 'packedBooleans' is set: these are stored as bit vectors in 64-bit words.
+struct LaneLayout {
+
+	int lanes;
+	bool packedBooleans;
+
+	LaneLayout(int theLanes = 1, bool thePackedBooleans = false) : lanes(theLanes), packedBooleans(thePackedBooleans) {}
+
+	bool IsTrivial() const
+	{
+		return lanes == 1 && !packedBooleans;
+	}
+
+	int GetNumberOfWords() const
+	{
+		return (lanes + 63) / 64;
+	}
+
+	// Number of elements of type T occupied by the lanes of one value
+	template<typename T>
+	int GetSize() const
+	{
+		return lanes;
+	}
+
+	template<typename T>
+	T Get(T const *values, int lane) const
+	{
+		return values[lane];
+	}
+
+	template<typename T>
+	void Set(T *values, int lane, T const &value) const
+	{
+		values[lane] = value;
+	}
+
+	// Sets the bool values of all lanes to predicate(lane). Packed lanes are
+	// assembled into whole words.
+	template<typename F>
+	void SetBooleans(bool *values, F const &predicate) const
+	{
+		if (!packedBooleans) {
+
+			for (int lane = 0; lane < lanes; ++lane)
+				values[lane] = predicate(lane);
+
+			return;
+		}
+
+		for (int word = 0; word < GetNumberOfWords(); ++word) {
+
+			int first = 64 * word;
+			int count = std::min(64, lanes - first);
+			std::uint64_t bits = 0;
+
+			for (int bit = 0; bit < count; ++bit)
+				bits |= std::uint64_t(predicate(first + bit) ? 1 : 0) << bit;
+
+			StoreWord(values, word, bits);
+		}
+	}
+};
+
+template<>
+inline int LaneLayout::GetSize<bool>() const
+{
+	return packedBooleans ? 8 * GetNumberOfWords() : lanes;
+}
+
+template<>
+inline bool LaneLayout::Get<bool>(bool const *values, int lane) const
+{
+	if (!packedBooleans)
+		return values[lane];
+
+	return ((LoadWord(values, lane / 64) >> (lane % 64)) & 1) != 0;
+}
+
+template<>
+inline void LaneLayout::Set<bool>(bool *values, int lane, bool const &value) const
+{
+	if (!packedBooleans) {
+
+		values[lane] = value;
+		return;
+	}
+
+	std::uint64_t mask = std::uint64_t(1) << (lane % 64);
+	std::uint64_t bits = LoadWord(values, lane / 64);
+	StoreWord(values, lane / 64, value ? bits | mask : bits & ~mask);
+}
+
+class ValueArena {
+
+private:
+
+	class PoolBase {
+
+	public:
+
+		types::TypeDescription::Class typeClass;
+		std::size_t capacity;
+
+		PoolBase(types::TypeDescription::Class theTypeClass) : typeClass(theTypeClass), capacity(0) {}
+		virtual ~PoolBase() {}
+
+		virtual std::size_t GetSize() const = 0;
+		virtual std::size_t GetBytes() const = 0;
+	};
+
+	template<typename T>
+	class Pool : public PoolBase {
+
+	public:
+
+		// Not a std::vector, which does not store bool values individually.
+		std::unique_ptr<T[]> values;
+		std::size_t size;
+
+		Pool() : PoolBase(types::GetDescription(T()).GetClass()), values(), size(0) {}
+
+		std::size_t GetSize() const override
+		{
+			return size;
+		}
+
+		std::size_t GetBytes() const override
+		{
+			return values ? capacity * sizeof(T) : 0;
+		}
+	};
+
+	LaneLayout layout;
+	std::unordered_map<std::type_index, std::unique_ptr<PoolBase>> pools;
+
+	template<typename T>
+	Pool<T> &GetPool()
+	{
+		auto &pool = pools[std::type_index(typeid(T))];
+		if (!pool)
+			pool = std::make_unique<Pool<T>>();
+
+		return static_cast<Pool<T> &>(*pool);
+	}
+
+public:
+
+	explicit ValueArena(LaneLayout const &layout);
+
+	LaneLayout const &GetLayout() const
+	{
+		return layout;
+	}
+
+	ValueArena(ValueArena const &) = delete;
+	ValueArena &operator =(ValueArena const &) = delete;
+
+	// Announces a value of type T. All values must be reserved before the
+	// first call to Allocate() so that the storage is never reallocated.
+	template<typename T>
+	void Reserve()
+	{
+		GetPool<T>().capacity += layout.GetSize<T>();
+	}
+
+	// Returns the address of the next free value of type T. All lanes are
+	// initialised to 'init'.
+	template<typename T>
+	T *Allocate(T const &init)
+	{
+		auto &pool = GetPool<T>();
+
+		if (!pool.values)
+			pool.values.reset(new T[pool.capacity]);
+
+		int size = layout.GetSize<T>();
+		assert(pool.size + size <= pool.capacity);
+
+		T *value = &pool.values[pool.size];
+		pool.size += size;
+
+		std::fill(value, value + size, T());
+		for (int lane = 0; lane < layout.lanes; ++lane)
+			layout.Set(value, lane, init);
+
+		return value;
+	}
+
+	void Report(std::basic_ostream<char> &os) const;
+};
+
+}
+}